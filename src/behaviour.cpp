@@ -0,0 +1,257 @@
+#include "behaviour.hpp"
+
+#include "components.hpp"
+#include "constants.hpp"
+#include "dynamic_body.hpp"
+#include "entt/entity/fwd.hpp"
+#include "entt/entt.hpp"
+#include "profiler.hpp"
+#include "raylib/raylib.h"
+#include "raylib/raymath.h"
+#include "registry.hpp"
+#include "routes.hpp"
+#include "ship.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace st {
+namespace behaviour {
+
+// ---------------------------------------------------------------
+// Frame arena
+
+// frames are rounded up to FRAME_SIZE_STEP, larger than MAX_FRAME_SIZE ones
+// go to the heap
+static const size_t FRAME_SIZE_STEP = 64;
+static const size_t MAX_FRAME_SIZE = 2048;
+static const size_t N_SIZE_CLASSES = MAX_FRAME_SIZE / FRAME_SIZE_STEP;
+static const size_t CHUNK_SIZE = 64 * 1024;
+
+// free blocks of a size class form a singly linked list through their first
+// bytes
+class FreeBlock {
+public:
+    FreeBlock *next;
+};
+
+static std::array<FreeBlock *, N_SIZE_CLASSES> FREE_LISTS = {};
+static std::vector<std::unique_ptr<std::byte[]>> CHUNKS;
+
+// Carves a new chunk into blocks of the size class.
+void grow_free_list(size_t size_class) {
+    size_t block_size = (size_class + 1) * FRAME_SIZE_STEP;
+    size_t n_blocks = CHUNK_SIZE / block_size;
+
+    CHUNKS.emplace_back(new std::byte[CHUNK_SIZE]);
+    std::byte *chunk = CHUNKS.back().get();
+    for (size_t i = 0; i < n_blocks; ++i) {
+        auto block = new (chunk + i * block_size) FreeBlock;
+        block->next = FREE_LISTS[size_class];
+        FREE_LISTS[size_class] = block;
+    }
+}
+
+void *allocate_frame(size_t size) {
+    if (size > MAX_FRAME_SIZE) return ::operator new(size);
+
+    size_t size_class = (size - 1) / FRAME_SIZE_STEP;
+    if (!FREE_LISTS[size_class]) grow_free_list(size_class);
+
+    FreeBlock *block = FREE_LISTS[size_class];
+    FREE_LISTS[size_class] = block->next;
+    return block;
+}
+
+void free_frame(void *frame, size_t size) {
+    if (size > MAX_FRAME_SIZE) {
+        ::operator delete(frame);
+        return;
+    }
+
+    size_t size_class = (size - 1) / FRAME_SIZE_STEP;
+    auto block = new (frame) FreeBlock;
+    block->next = FREE_LISTS[size_class];
+    FREE_LISTS[size_class] = block;
+}
+
+// ---------------------------------------------------------------
+// Timer wheel
+
+// Level 0 has a slot per tick of the next N_LEVEL_0_SLOTS ticks. Level 1 has
+// a slot per N_LEVEL_0_SLOTS ticks, a slot is cascaded into level 0 when the
+// wheel gets to it. Farther timers wait in the last level 1 slot and are
+// cascaded again, until they're close enough.
+static const uint64_t LEVEL_0_BITS = 8;
+static const uint64_t N_LEVEL_0_SLOTS = 1 << LEVEL_0_BITS;
+static const uint64_t N_LEVEL_1_SLOTS = 64;
+
+class Timer {
+public:
+    std::coroutine_handle<> handle;
+    uint64_t tick;
+};
+
+static uint64_t TICK = 0;
+static std::array<std::vector<Timer>, N_LEVEL_0_SLOTS> LEVEL_0;
+static std::array<std::vector<Timer>, N_LEVEL_1_SLOTS> LEVEL_1;
+
+// due timers are swapped out here, so the resumed tasks can schedule freely
+static std::vector<Timer> DUE_TIMERS;
+
+static int N_TASKS = 0;
+
+void add_timer(Timer timer) {
+    uint64_t round = TICK >> LEVEL_0_BITS;
+    uint64_t timer_round = timer.tick >> LEVEL_0_BITS;
+
+    if (timer.tick - TICK < N_LEVEL_0_SLOTS) {
+        LEVEL_0[timer.tick % N_LEVEL_0_SLOTS].push_back(timer);
+    } else if (timer_round - round < N_LEVEL_1_SLOTS) {
+        LEVEL_1[timer_round % N_LEVEL_1_SLOTS].push_back(timer);
+    } else {
+        LEVEL_1[(round + N_LEVEL_1_SLOTS - 1) % N_LEVEL_1_SLOTS].push_back(timer);
+    }
+}
+
+void schedule(std::coroutine_handle<> handle, uint64_t tick) {
+    add_timer({.handle = handle, .tick = std::max(tick, TICK + 1)});
+}
+
+uint64_t get_tick() {
+    return TICK;
+}
+
+void update() {
+    TICK += 1;
+
+    if (TICK % N_LEVEL_0_SLOTS == 0) {
+        auto &slot = LEVEL_1[(TICK >> LEVEL_0_BITS) % N_LEVEL_1_SLOTS];
+        std::swap(slot, DUE_TIMERS);
+        for (Timer timer : DUE_TIMERS) add_timer(timer);
+        DUE_TIMERS.clear();
+    }
+
+    auto &slot = LEVEL_0[TICK % N_LEVEL_0_SLOTS];
+    std::swap(slot, DUE_TIMERS);
+    for (Timer timer : DUE_TIMERS) timer.handle.resume();
+
+    profiler::add_counter("behaviours.n_resumed", DUE_TIMERS.size());
+    profiler::set_counter("behaviours.n_tasks", N_TASKS);
+    DUE_TIMERS.clear();
+}
+
+// ---------------------------------------------------------------
+// Tasks
+
+std::coroutine_handle<> Task::FinalAwaiter::await_suspend(Handle handle) noexcept {
+    std::coroutine_handle<> continuation = handle.promise().continuation;
+    if (continuation) return continuation;
+
+    handle.destroy();
+    N_TASKS -= 1;
+    return std::noop_coroutine();
+}
+
+Task::Task(Handle handle)
+    : handle(handle) {}
+
+Task::Task(Task &&other) noexcept
+    : handle(std::exchange(other.handle, nullptr)) {}
+
+Task::~Task() {
+    if (this->handle) this->handle.destroy();
+}
+
+std::coroutine_handle<> Task::await_suspend(std::coroutine_handle<> awaiting) {
+    this->handle.promise().continuation = awaiting;
+    return this->handle;
+}
+
+Delay::Delay(uint64_t n_ticks)
+    : n_ticks(n_ticks) {}
+
+void Delay::await_suspend(std::coroutine_handle<> handle) const {
+    schedule(handle, TICK + this->n_ticks);
+}
+
+Delay next_tick() {
+    return Delay(1);
+}
+
+Delay wait(float seconds) {
+    return Delay(std::ceil(seconds / DT));
+}
+
+void start(Task task) {
+    // the task destroys its own frame when it returns
+    Task::Handle handle = std::exchange(task.handle, nullptr);
+    N_TASKS += 1;
+    handle.resume();
+}
+
+// checking an arrival more often than this is pointless
+static const float MIN_ARRIVAL_CHECK_PERIOD = 0.1;
+
+Task arrive(entt::entity ship_entity, Vector2 position, float radius) {
+    registry::registry.get<ship::Ship>(ship_entity).target_position = position;
+
+    while (true) {
+        // components may move in memory while the task is suspended
+        auto [transform, body, ship] = registry::registry.get<
+            components::Transform,
+            dynamic_body::DynamicBody,
+            ship::Ship>(ship_entity);
+
+        float dist = Vector2Distance(transform.position, position);
+        if (dist <= radius) co_return;
+
+        float speed = ship.force / body.linear_damping;
+        float time = (dist - radius) / speed;
+        co_await wait(std::max(time, MIN_ARRIVAL_CHECK_PERIOD));
+    }
+}
+
+// ---------------------------------------------------------------
+// Behaviours
+
+static const float FERRY_MIN_DOCK_TIME = 5.0;
+static const float FERRY_MAX_DOCK_TIME = 20.0;
+static const float FERRY_WAYPOINT_RADIUS = 1.0;
+static const int FERRY_N_DEST_ATTEMPTS = 8;
+
+Task ferry(entt::entity ship_entity, int port_idx) {
+    int n_ports = registry::get_ports_group().size();
+
+    while (true) {
+        float k = (float)std::rand() / RAND_MAX;
+        float dock_time = FERRY_MIN_DOCK_TIME
+                          + k * (FERRY_MAX_DOCK_TIME - FERRY_MIN_DOCK_TIME);
+        co_await wait(dock_time);
+
+        int dest_port_idx = -1;
+        for (int i = 0; i < FERRY_N_DEST_ATTEMPTS && dest_port_idx == -1; ++i) {
+            int idx = std::rand() % n_ports;
+            if (!routes::get_path(port_idx, idx).empty()) dest_port_idx = idx;
+        }
+        if (dest_port_idx == -1) continue;
+
+        // paths don't change after routes::load, the reference stays valid
+        const auto &path = routes::get_path(port_idx, dest_port_idx);
+        for (Vector2 waypoint : path) {
+            co_await arrive(ship_entity, waypoint, FERRY_WAYPOINT_RADIUS);
+        }
+        port_idx = dest_port_idx;
+    }
+}
+
+}  // namespace behaviour
+}  // namespace st
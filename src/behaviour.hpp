@@ -0,0 +1,123 @@
+#pragma once
+
+#include "entt/entity/fwd.hpp"
+#include "entt/entt.hpp"
+#include "raylib/raylib.h"
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+
+namespace st {
+namespace behaviour {
+
+// Coroutine frames come from pooled fixed size blocks (one free list per size
+// class) instead of the heap. Like everything else here, simulation thread
+// only.
+void *allocate_frame(size_t size);
+void free_frame(void *frame, size_t size);
+
+// Resumes the coroutine on the given behaviour tick (must be in the future).
+void schedule(std::coroutine_handle<> handle, uint64_t tick);
+uint64_t get_tick();
+
+// Multi-step entity behaviour written as a coroutine. A task starts
+// suspended: either pass it to start() or co_await it from another task,
+// which is resumed when the awaited one is done.
+class Task {
+public:
+    class promise_type;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    // Hands control back to the awaiting task. A started (top level) task has
+    // none, it destroys itself.
+    class FinalAwaiter {
+    public:
+        bool await_ready() noexcept {
+            return false;
+        }
+        std::coroutine_handle<> await_suspend(Handle handle) noexcept;
+        void await_resume() noexcept {}
+    };
+
+    class promise_type {
+    public:
+        std::coroutine_handle<> continuation;
+
+        void *operator new(size_t size) {
+            return allocate_frame(size);
+        }
+        void operator delete(void *frame, size_t size) {
+            free_frame(frame, size);
+        }
+
+        Task get_return_object() {
+            return Task(Handle::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+        FinalAwaiter final_suspend() noexcept {
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() {
+            throw;
+        }
+    };
+
+    Handle handle;
+
+    explicit Task(Handle handle);
+    Task(Task &&other) noexcept;
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+    ~Task();
+
+    bool await_ready() const {
+        return !this->handle || this->handle.done();
+    }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting);
+    void await_resume() {}
+};
+
+// co_await Delay(n) suspends the task for n behaviour ticks (at least one).
+class Delay {
+public:
+    uint64_t n_ticks;
+
+    explicit Delay(uint64_t n_ticks);
+
+    bool await_ready() const {
+        return false;
+    }
+    void await_suspend(std::coroutine_handle<> handle) const;
+    void await_resume() const {}
+};
+
+Delay next_tick();
+Delay wait(float seconds);
+
+// Steers the ship (ship::ControllerType::FERRY) toward the position and
+// finishes once it's within the radius. The ship can't get there faster than
+// at its cruise speed, so the task sleeps until the earliest possible arrival
+// and only then checks again.
+Task arrive(entt::entity ship_entity, Vector2 position, float radius);
+
+// Runs the task until its first suspension. The task then lives until it
+// returns.
+void start(Task task);
+
+// Advances the behaviour tick and resumes the tasks due on it. Tasks are kept
+// in a two level timer wheel, so suspended tasks cost nothing until they're
+// due.
+void update();
+
+// ---------------------------------------------------------------
+// Behaviours
+
+// Waits at the port for a while, sails the route to a random other port,
+// and again, forever.
+Task ferry(entt::entity ship_entity, int port_idx);
+
+}  // namespace behaviour
+}  // namespace st
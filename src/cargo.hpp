@@ -2,6 +2,7 @@
 
 #include <array>
 #include <climits>
+#include <string_view>
 
 namespace st {
 namespace cargo {
@@ -24,35 +25,84 @@ enum class ProductID {
 
 static const int N_PRODUCTS = (int)ProductID::_N_PRODUCTS;
 
+// Static product data, shared by all cargos.
 class Product {
 public:
     ProductID id;
     int unit_weight;
     int base_price;
+};
+
+constexpr std::array<Product, N_PRODUCTS> PRODUCTS = {
+    {{.id = ProductID::PROVISION_ID, .unit_weight = 10, .base_price = 5},
+     {.id = ProductID::SPICES_ID, .unit_weight = 2, .base_price = 50},
+     {.id = ProductID::SUGAR_ID, .unit_weight = 5, .base_price = 20},
+     {.id = ProductID::TEA_ID, .unit_weight = 1, .base_price = 30},
+     {.id = ProductID::TOBACCO_ID, .unit_weight = 3, .base_price = 40},
+     {.id = ProductID::RUM_ID, .unit_weight = 8, .base_price = 25},
+     {.id = ProductID::COTTON_ID, .unit_weight = 4, .base_price = 15},
+     {.id = ProductID::SILK_ID, .unit_weight = 1, .base_price = 100},
+     {.id = ProductID::GRAIN_ID, .unit_weight = 7, .base_price = 10},
+     {.id = ProductID::WOOD_ID, .unit_weight = 20, .base_price = 5},
+     {.id = ProductID::SILVER_ID, .unit_weight = 50, .base_price = 500},
+     {.id = ProductID::GOLD_ID, .unit_weight = 50, .base_price = 1000}}
+};
 
-    float buy_price_coeff = 1.0;
-    float sell_price_coeff = 1.0;
-    int n_units = 0;
+constexpr const Product &get_product(ProductID id) {
+    return PRODUCTS[(int)id];
+}
 
-    std::string get_name();
-    int get_buy_price();
-    int get_sell_price();
-    int get_weight();
+constexpr std::array<std::string_view, N_PRODUCTS> PRODUCT_NAMES = {
+    "Provision",
+    "Spices",
+    "Sugar",
+    "Tea",
+    "Tobacco",
+    "Rum",
+    "Cotton",
+    "Silk",
+    "Grain",
+    "Wood",
+    "Silver",
+    "Gold",
 };
 
+constexpr std::string_view get_name(ProductID id) {
+    return PRODUCT_NAMES[(int)id];
+}
+
+// Per-entity cargo: only the unit counts, indexed by ProductID. The total
+// weight is kept up to date by the mutation methods.
 class Cargo {
+private:
+    std::array<int, N_PRODUCTS> n_units = {};
+    int weight = 0;
+
 public:
-    std::array<Product, N_PRODUCTS> products;
     int capacity = INT_MAX;
 
     Cargo();
     Cargo(int capacity);
-    Cargo(const Cargo &other);
 
+    int get_n_units(ProductID id) const;
+    void add_units(ProductID id, int n);
+    void remove_units(ProductID id, int n);
     void empty();
-    Product &get_product(ProductID idx);
-    int get_weight();
-    int get_free_weight();
+
+    int get_weight() const;
+    int get_free_weight() const;
+};
+
+// Per-port price modifiers, indexed by ProductID.
+class Prices {
+public:
+    std::array<float, N_PRODUCTS> buy_price_coeffs;
+    std::array<float, N_PRODUCTS> sell_price_coeffs;
+
+    Prices();
+
+    int get_buy_price(ProductID id) const;
+    int get_sell_price(ProductID id) const;
 };
 
 }  // namespace cargo
@@ -14,8 +14,9 @@ Vector2 Transform::get_forward() {
     return {cosf(this->rotation), sinf(this->rotation)};
 }
 
-Port::Port(float radius, cargo::Cargo cargo)
+Port::Port(float radius, Vector2 dock_position, const cargo::Cargo &cargo)
     : radius(radius)
+    , dock_position(dock_position)
     , cargo(cargo) {}
 
 Money::Money() = default;
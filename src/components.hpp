@@ -18,10 +18,13 @@ public:
 
 class Port {
 public:
-    const float radius;
+    float radius;
+    // water position next to the port where ships come to trade
+    Vector2 dock_position;
     cargo::Cargo cargo;
+    cargo::Prices prices;
 
-    Port(float radius, cargo::Cargo);
+    Port(float radius, Vector2 dock_position, const cargo::Cargo &cargo);
 };
 
 class Money {
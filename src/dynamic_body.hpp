@@ -1,7 +1,6 @@
 #pragma once
 
-#include "entt/entity/fwd.hpp"
-#include "entt/entt.hpp"
+#include "components.hpp"
 #include "raylib/raylib.h"
 
 namespace st {
@@ -9,8 +8,6 @@ namespace dynamic_body {
 
 class DynamicBody {
 public:
-    entt::entity entity;
-
     Vector2 linear_velocity = {0.0, 0.0};
     float angular_velocity = 0.0;
     Vector2 net_force = {0.0, 0.0};
@@ -23,17 +20,13 @@ public:
     float angular_damping;
 
     DynamicBody(
-        entt::entity entity,
-        float mass,
-        float linear_damping,
-        float moment_of_inertia,
-        float angular_damping
+        float mass, float linear_damping, float moment_of_inertia, float angular_damping
     );
 
     void apply_force(Vector2 direction, float magnitude);
     void apply_torque(float magnitude);
 
-    void update();
+    void update(components::Transform &transform, float dt);
 };
 
 }  // namespace dynamic_body
@@ -0,0 +1,203 @@
+#include "economy.hpp"
+
+#include "cargo.hpp"
+#include "components.hpp"
+#include "jobs.hpp"
+#include "registry.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+namespace st {
+namespace economy {
+
+// stock the port aims for if it had none of the product at load
+static const float DEFAULT_TARGET_STOCK = 100.0;
+
+// share of port/product pairs which are produced or consumed, and the rate
+// range (fraction of the target stock per second)
+static const float PRODUCER_CHANCE = 0.3;
+static const float CONSUMER_CHANCE = 0.3;
+static const float MIN_RATE = 0.002;
+static const float MAX_RATE = 0.01;
+
+// prices look this many seconds ahead: a port which is running out of a
+// product raises its price before the stock is actually gone
+static const float FLOW_HORIZON = 30.0;
+
+// port sells above and buys below the mid price
+static const float PRICE_SPREAD = 0.1;
+static const float MIN_PRICE_COEFF = 0.25;
+static const float MAX_PRICE_COEFF = 4.0;
+
+// time constant (seconds) of the mid price moving toward the equilibrium
+static const float PRICE_RESPONSE_TIME = 10.0;
+
+static const int PORTS_GRAIN_SIZE = 256;
+
+// Market state in structure-of-arrays layout: one row of N_PORTS values per
+// product, so each product's pass over the ports is a contiguous, branchless
+// loop the compiler can vectorize. Port i is the i-th port of the ports
+// group.
+static int N_PORTS = 0;
+static std::vector<float> STOCKS;
+static std::vector<float> TARGET_STOCKS;
+static std::vector<float> PRODUCTION_RATES;
+static std::vector<float> CONSUMPTION_RATES;
+static std::vector<float> FLOWS;
+static std::vector<float> FLOW_REMAINDERS;
+static std::vector<float> MID_PRICE_COEFFS;
+
+// the arrays which carry over between updates, the rest is gathered anew
+std::array<std::vector<float> *, N_STATE_ARRAYS> get_state_arrays() {
+    return {
+        &TARGET_STOCKS,
+        &PRODUCTION_RATES,
+        &CONSUMPTION_RATES,
+        &FLOW_REMAINDERS,
+        &MID_PRICE_COEFFS,
+    };
+}
+
+float *get_row(std::vector<float> &values, int product_idx) {
+    return values.data() + product_idx * N_PORTS;
+}
+
+float get_random_float(float min, float max) {
+    return min + (max - min) * (float)std::rand() / RAND_MAX;
+}
+
+// Production and consumption over dt. Cargo holds whole units, so the
+// fractional part of the flow is carried over to the next update.
+void update_stocks_range(int begin, int end, float dt) {
+    auto group = registry::get_ports_group();
+    auto ports = group.storage<components::Port>()->rbegin();
+
+    for (int p = 0; p < cargo::N_PRODUCTS; ++p) {
+        auto product_id = (cargo::ProductID)p;
+        int unit_weight = cargo::get_product(product_id).unit_weight;
+        float *production_rates = get_row(PRODUCTION_RATES, p);
+        float *consumption_rates = get_row(CONSUMPTION_RATES, p);
+        float *flows = get_row(FLOWS, p);
+        float *remainders = get_row(FLOW_REMAINDERS, p);
+
+        for (int i = begin; i < end; ++i) {
+            float flow = (production_rates[i] - consumption_rates[i]) * dt;
+            flows[i] = (int)(flow + remainders[i]);
+            remainders[i] += flow - flows[i];
+        }
+
+        for (int i = begin; i < end; ++i) {
+            auto &cargo = ports[i].cargo;
+            int n_units = flows[i];
+            n_units = std::max(n_units, -cargo.get_n_units(product_id));
+            n_units = std::min(n_units, cargo.get_free_weight() / unit_weight);
+            cargo.add_units(product_id, n_units);
+        }
+    }
+}
+
+void update_prices_range(int begin, int end, float dt) {
+    auto group = registry::get_ports_group();
+    auto ports = group.storage<components::Port>()->rbegin();
+    float response = 1.0f - std::exp(-dt / PRICE_RESPONSE_TIME);
+
+    for (int p = 0; p < cargo::N_PRODUCTS; ++p) {
+        auto product_id = (cargo::ProductID)p;
+        float *stocks = get_row(STOCKS, p);
+        float *target_stocks = get_row(TARGET_STOCKS, p);
+        float *production_rates = get_row(PRODUCTION_RATES, p);
+        float *consumption_rates = get_row(CONSUMPTION_RATES, p);
+        float *mid_coeffs = get_row(MID_PRICE_COEFFS, p);
+
+        // gather
+        for (int i = begin; i < end; ++i) {
+            stocks[i] = ports[i].cargo.get_n_units(product_id);
+        }
+
+        // 2 for an empty port, 1 at the target stock, toward 0 beyond it
+        for (int i = begin; i < end; ++i) {
+            float net_rate = production_rates[i] - consumption_rates[i];
+            float stock = std::max(stocks[i] + net_rate * FLOW_HORIZON, 0.0f);
+            float coeff = 2.0f / (1.0f + stock / target_stocks[i]);
+            coeff = std::clamp(coeff, MIN_PRICE_COEFF, MAX_PRICE_COEFF);
+            mid_coeffs[i] += (coeff - mid_coeffs[i]) * response;
+        }
+
+        // scatter
+        for (int i = begin; i < end; ++i) {
+            auto &prices = ports[i].prices;
+            prices.buy_price_coeffs[p] = mid_coeffs[i] * (1.0f - PRICE_SPREAD);
+            prices.sell_price_coeffs[p] = mid_coeffs[i] * (1.0f + PRICE_SPREAD);
+        }
+    }
+}
+
+void allocate() {
+    N_PORTS = registry::get_ports_group().size();
+    int size = cargo::N_PRODUCTS * N_PORTS;
+    STOCKS.assign(size, 0.0);
+    TARGET_STOCKS.assign(size, 0.0);
+    PRODUCTION_RATES.assign(size, 0.0);
+    CONSUMPTION_RATES.assign(size, 0.0);
+    FLOWS.assign(size, 0.0);
+    FLOW_REMAINDERS.assign(size, 0.0);
+    MID_PRICE_COEFFS.assign(size, 1.0);
+}
+
+void load() {
+    auto ports = registry::get_ports_group().storage<components::Port>()->rbegin();
+    allocate();
+
+    for (int p = 0; p < cargo::N_PRODUCTS; ++p) {
+        float *target_stocks = get_row(TARGET_STOCKS, p);
+        float *production_rates = get_row(PRODUCTION_RATES, p);
+        float *consumption_rates = get_row(CONSUMPTION_RATES, p);
+
+        for (int i = 0; i < N_PORTS; ++i) {
+            int n_units = ports[i].cargo.get_n_units((cargo::ProductID)p);
+            target_stocks[i] = n_units > 0 ? n_units : DEFAULT_TARGET_STOCK;
+
+            float roll = get_random_float(0.0, 1.0);
+            float rate = target_stocks[i] * get_random_float(MIN_RATE, MAX_RATE);
+            if (roll < PRODUCER_CHANCE) {
+                production_rates[i] = rate;
+            } else if (roll < PRODUCER_CHANCE + CONSUMER_CHANCE) {
+                consumption_rates[i] = rate;
+            }
+        }
+    }
+
+    // start right at the equilibrium prices
+    update_prices_range(0, N_PORTS, PRICE_RESPONSE_TIME * 1000.0f);
+}
+
+void load(const float *const *state_arrays) {
+    allocate();
+
+    auto arrays = get_state_arrays();
+    for (int i = 0; i < N_STATE_ARRAYS; ++i) {
+        std::copy_n(state_arrays[i], arrays[i]->size(), arrays[i]->begin());
+    }
+}
+
+void update(float dt) {
+    int n_ports = std::min<int>(N_PORTS, registry::get_ports_group().size());
+    jobs::parallel_for(0, n_ports, PORTS_GRAIN_SIZE, [dt](int begin, int end) {
+        update_stocks_range(begin, end, dt);
+        update_prices_range(begin, end, dt);
+    });
+}
+
+const float *get_mid_price_coeffs() {
+    return MID_PRICE_COEFFS.data();
+}
+
+const float *get_state_array(int idx) {
+    return get_state_arrays()[idx]->data();
+}
+
+}  // namespace economy
+}  // namespace st
@@ -0,0 +1,34 @@
+#pragma once
+
+namespace st {
+namespace economy {
+
+// number of arrays making up the persistent market state
+static const int N_STATE_ARRAYS = 5;
+
+// Builds the market arrays for the ports that exist at the moment (call it
+// after the ports are spawned). The initial port stock becomes the stock
+// the port's prices are balanced around, and every port gets random
+// production and consumption rates.
+void load();
+
+// Like load, but restores the market state from arrays saved with
+// get_state_array instead of rolling new rates. The arrays are copied.
+void load(const float *const *state_arrays);
+
+// One economy step covering dt seconds, batched over all ports: ports
+// produce and consume goods, then every port's buy/sell price coefficients
+// move toward the supply/demand equilibrium. Meant to run at a lower
+// frequency than the physics, with a correspondingly larger dt.
+void update(float dt);
+
+// Current mid price coefficients (between the buy and the sell one),
+// product-major: one row of n_ports values per product, in ports group order.
+const float *get_mid_price_coeffs();
+
+// One of the N_STATE_ARRAYS persistent market arrays, in the same layout:
+// N_PRODUCTS rows of n_ports values.
+const float *get_state_array(int idx);
+
+}  // namespace economy
+}  // namespace st
@@ -1,32 +1,108 @@
 #include "game.hpp"
 
+#include "behaviour.hpp"
 #include "camera.hpp"
 #include "cargo.hpp"
 #include "components.hpp"
 #include "constants.hpp"
 #include "dynamic_body.hpp"
+#include "economy.hpp"
 #include "entt/entity/fwd.hpp"
 #include "entt/entt.hpp"
+#include "input.hpp"
+#include "jobs.hpp"
+#include "lod.hpp"
+#include "order_book.hpp"
+#include "port_index.hpp"
+#include "port_zones.hpp"
+#include "price_history.hpp"
 #include "profiler.hpp"
 #include "raylib/raylib.h"
 #include "raylib/raymath.h"
 #include "registry.hpp"
+#include "render_state.hpp"
 #include "renderer.hpp"
 #include "resources.hpp"
+#include "routes.hpp"
+#include "save.hpp"
+#include "scheduler.hpp"
 #include "ship.hpp"
 #include "shop.hpp"
+#include "snapshot.hpp"
+#include "spawn.hpp"
 #include "terrain.hpp"
+#include "trader.hpp"
 #include "ui.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cfloat>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace st {
 namespace game {
 
-static bool WINDOW_SHOULD_CLOSE = false;
+static std::atomic<bool> WINDOW_SHOULD_CLOSE = false;
+
+// Guards the registry between the simulation thread and the render thread
+// (the shop reads and trades on the registry directly).
+static std::mutex WORLD_MUTEX;
+
+// fixed-step loop budget: at most MAX_N_STEPS_PER_FRAME catch-up ticks per
+// simulation wake-up, the rest of the backlog is dropped
+static int MAX_N_STEPS_PER_FRAME = 8;
+
+// adaptive mode: NPCs tick every NPC_TICK_DIVIDER-th tick while the
+// simulation can't keep up, and recover after N_CALM_FRAMES_TO_RECOVER
+static bool IS_NPC_TICK_RATE_ADAPTIVE = false;
+static const int MAX_NPC_TICK_DIVIDER = 8;
+static const int N_CALM_FRAMES_TO_RECOVER = 60;
+
+// the economy (production, consumption, prices) and then the order matching
+// run every N_TICKS_PER_ECONOMY_UPDATE-th tick, batched over all ports
+static int N_TICKS_PER_ECONOMY_UPDATE = 60;
+
+// ship LOD tiers (update rates by distance to the player and the view) are
+// reassigned every N_TICKS_PER_LOD_UPDATE-th tick
+static const int N_TICKS_PER_LOD_UPDATE = 60;
+
+// debug snapshots of the registry: F5 takes one, F9 rolls back to the latest
+static const int N_SNAPSHOTS = 8;
+
+// the world is loaded from LOAD_PATH instead of being generated if it's set,
+// and saved to SAVE_PATH on exit
+static std::string LOAD_PATH;
+static std::string SAVE_PATH;
+
+// extra NPCs spawned in random water positions, for load testing
+static int N_EXTRA_NPCS = 0;
+
+// NPC traders spawned at random port docks
+static int N_TRADERS = 16;
+
+// NPC ferries (behaviour::ferry tasks) spawned at random port docks
+static int N_FERRIES = 8;
+
+static uint64_t TICK = 0;
+static entt::entity PLAYER_ENTITY = entt::null;
+
+// port whose zone the player is in, kept by the port zone events
+static int PLAYER_PORT_IDX = -1;
+static int NPC_TICK_DIVIDER = 1;
+
+static const auto START_TIME = std::chrono::steady_clock::now();
+
+double get_time() {
+    auto time = std::chrono::steady_clock::now() - START_TIME;
+    return std::chrono::duration<double>(time).count();
+}
 
 Vector2 screen_to_world(Vector2 screen_position) {
     Vector2 screen_size = {(float)renderer::SCREEN_WIDTH, (float)renderer::SCREEN_HEIGHT};
@@ -42,117 +118,188 @@ Vector2 screen_to_world(Vector2 screen_position) {
     return {.x = x, .y = y};
 }
 
-entt::entity create_ship(Vector2 position, ship::ControllerType controller_type) {
-    auto entity = registry::registry.create();
+void update_player_entering_port() {
+    bool is_enter_pressed = input::is_key_pressed(KEY_ENTER);
+    if (!is_enter_pressed) return;
 
-    // transform
-    components::Transform transform(position, 0.0);
+    if (PLAYER_PORT_IDX != -1) shop::open(registry::get_port_entity(PLAYER_PORT_IDX));
+}
 
-    // dynamic_body
-    dynamic_body::DynamicBody body(entity, 1000.0, 1000.0, 1.0, 10.0);
+void on_port_zone_event(const port_zones::Event &event) {
+    if (event.ship_entity != PLAYER_ENTITY) return;
 
-    // ship
-    cargo::Cargo cargo(1000);
-    cargo.get_product(cargo::ProductID::PROVISION_ID).n_units = 30;
-    cargo.get_product(cargo::ProductID::RUM_ID).n_units = 10;
-    cargo.get_product(cargo::ProductID::WOOD_ID).n_units = 5;
-    ship::Ship ship(entity, controller_type, cargo);
+    bool is_enter = event.type == port_zones::EventType::ENTER;
+    PLAYER_PORT_IDX = is_enter ? event.port_idx : -1;
+}
 
-    // money
-    components::Money money(1000);
+// The player ticks every tick. NPCs tick every n-th tick (phase-shifted by
+// entity) with a scaled dt, n is the larger of NPC_TICK_DIVIDER and the
+// ship's LOD divider. Returns 0 if the entity skips this tick.
+float get_tick_dt(int ship_idx, entt::entity entity) {
+    if (entity == PLAYER_ENTITY) return DT;
 
-    // entity
-    registry::registry.emplace<components::Transform>(entity, transform);
-    registry::registry.emplace<dynamic_body::DynamicBody>(entity, body);
-    registry::registry.emplace<ship::Ship>(entity, ship);
-    registry::registry.emplace<components::Money>(entity, money);
+    int divider = std::max(NPC_TICK_DIVIDER, lod::get_tick_divider(ship_idx));
+    if (divider == 1) return DT;
 
-    return entity;
+    uint64_t phase = entt::to_entity(entity) + TICK;
+    if (phase % divider != 0) return 0.0;
+    return DT * divider;
 }
 
-entt::entity create_player(Vector2 position) {
-    auto entity = create_ship(position, ship::ControllerType::MANUAL);
-    registry::registry.emplace<components::Player>(entity);
+static const int SHIPS_GRAIN_SIZE = 1024;
 
-    return entity;
+void update_ships() {
+    auto group = registry::get_ships_group();
+    auto entities = group.storage<components::Transform>()->data();
+    auto transforms = group.storage<components::Transform>()->rbegin();
+    auto bodies = group.storage<dynamic_body::DynamicBody>()->rbegin();
+    auto ships = group.storage<ship::Ship>()->rbegin();
+
+    jobs::parallel_for(0, group.size(), SHIPS_GRAIN_SIZE, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            if (lod::check_if_analytic(i)) continue;
+            if (get_tick_dt(i, entities[i]) == 0.0) continue;
+            ships[i].update(transforms[i], bodies[i]);
+        }
+    });
 }
 
-entt::entity create_port(Vector2 position) {
-    auto entity = registry::registry.create();
-
-    // transform
-    components::Transform transform(position, 0.0);
-
-    // money
-    components::Money money(500000);
-
-    // port
-    cargo::Cargo cargo(1000000);
-    cargo.get_product(cargo::ProductID::PROVISION_ID).n_units = 1000;
-    cargo.get_product(cargo::ProductID::RUM_ID).n_units = 1000;
-    cargo.get_product(cargo::ProductID::WOOD_ID).n_units = 500;
-    cargo.get_product(cargo::ProductID::SILVER_ID).n_units = 50;
-    cargo.get_product(cargo::ProductID::GOLD_ID).n_units = 25;
-    components::Port port(3.0, cargo);
+void update_dynamic_bodies() {
+    auto group = registry::get_ships_group();
+    auto entities = group.storage<components::Transform>()->data();
+    auto transforms = group.storage<components::Transform>()->rbegin();
+    auto bodies = group.storage<dynamic_body::DynamicBody>()->rbegin();
+    auto ships = group.storage<ship::Ship>()->rbegin();
+
+    jobs::parallel_for(0, group.size(), SHIPS_GRAIN_SIZE, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            float dt = get_tick_dt(i, entities[i]);
+            if (dt == 0.0) continue;
+
+            if (lod::check_if_analytic(i)) ships[i].advance(transforms[i], bodies[i], dt);
+            else bodies[i].update(transforms[i], dt);
+        }
+    });
+}
 
-    // entity
-    registry::registry.emplace<components::Transform>(entity, transform);
-    registry::registry.emplace<components::Port>(entity, port);
-    registry::registry.emplace<components::Money>(entity, money);
+void update_lod() {
+    if (TICK % N_TICKS_PER_LOD_UPDATE != 0) return;
+    auto &player_transform = registry::registry.get<components::Transform>(PLAYER_ENTITY);
+    lod::update(player_transform.position);
+}
 
-    return entity;
+void update_economy() {
+    if (TICK % N_TICKS_PER_ECONOMY_UPDATE != 0) return;
+    economy::update(DT * N_TICKS_PER_ECONOMY_UPDATE);
+    routes::update();
+    price_history::record(economy::get_mid_price_coeffs());
 }
 
-void update_player_entering_port() {
-    bool is_enter_pressed = IsKeyPressed(KEY_ENTER);
-    if (!is_enter_pressed) return;
+void update_order_books() {
+    if (TICK % N_TICKS_PER_ECONOMY_UPDATE != 0) return;
+    order_book::match();
+    trader::on_match();
 
-    auto player_entity = registry::registry.view<components::Player>().front();
-    auto &player_transform = registry::registry.get<components::Transform>(player_entity);
+    int n_units = 0;
+    for (auto &fill : order_book::get_fills()) n_units += fill.n_units;
+    profiler::add_counter("order_book.n_fills", order_book::get_fills().size());
+    profiler::add_counter("order_book.n_units", n_units);
+}
 
-    auto view = registry::registry.view<components::Transform, components::Port>();
-    for (auto port_entity : view) {
-        auto [port_transform, port] = view.get(port_entity);
-        float dist = Vector2Distance(player_transform.position, port_transform.position);
-        if (dist <= port.radius) {
-            shop::open(port_entity);
-            return;
-        }
-    }
+void update_window_should_close() {
+    bool is_alt_f4_pressed = IsKeyDown(KEY_LEFT_ALT) && IsKeyPressed(KEY_F4);
+    WINDOW_SHOULD_CLOSE = (WindowShouldClose() || is_alt_f4_pressed);
 }
 
-void update_ships() {
-    auto view = registry::registry.view<ship::Ship>();
-    for (auto entity : view) {
-        auto &ship = registry::registry.get<ship::Ship>(entity);
-        ship.update();
-    }
+void load_systems() {
+    using components::Money;
+    using components::Player;
+    using components::Port;
+    using components::Transform;
+    using dynamic_body::DynamicBody;
+    using scheduler::access;
+    using ship::Ship;
+    using trader::Trader;
+
+    scheduler::add_system(
+        "update_port_zones",
+        access<Transform>(),
+        access<port_zones::Presence, Trader>(),
+        port_zones::update
+    );
+    scheduler::add_system(
+        "update_player_entering_port",
+        access<Port, port_zones::Presence>(),
+        access<>(),
+        update_player_entering_port
+    );
+    scheduler::add_system(
+        "update_traders",
+        access<Transform, DynamicBody>(),
+        access<Trader, Ship, Money, Port>(),
+        trader::update
+    );
+    scheduler::add_system(
+        "update_behaviours",
+        access<Transform, DynamicBody>(),
+        access<Ship>(),
+        behaviour::update
+    );
+    scheduler::add_system(
+        "update_lod", access<Transform, Ship>(), access<lod::Tier>(), update_lod
+    );
+    scheduler::add_system(
+        "update_ships",
+        access<Transform, lod::Tier>(),
+        access<DynamicBody, Ship>(),
+        update_ships
+    );
+    scheduler::add_system(
+        "update_dynamic_bodies",
+        access<Ship, lod::Tier>(),
+        access<Transform, DynamicBody>(),
+        update_dynamic_bodies
+    );
+    scheduler::add_system(
+        "update_economy", access<>(), access<Port>(), update_economy
+    );
+    // fills move cargo and money between ships and ports
+    scheduler::add_system(
+        "update_order_books",
+        access<>(),
+        access<Port, Ship, Money, Trader>(),
+        update_order_books
+    );
+
+    scheduler::build();
 }
 
-void update_dynamic_bodies() {
-    auto view = registry::registry.view<dynamic_body::DynamicBody>();
-    for (auto entity : view) {
-        auto &body = registry::registry.get<dynamic_body::DynamicBody>(entity);
-        body.update();
-    }
+void update_world() {
+    scheduler::run();
 }
 
-void update_window_should_close() {
-    bool is_alt_f4_pressed = IsKeyDown(KEY_LEFT_ALT) && IsKeyPressed(KEY_F4);
-    WINDOW_SHOULD_CLOSE = (WindowShouldClose() || is_alt_f4_pressed);
+void update_snapshots() {
+    if (input::is_key_pressed(KEY_F5)) snapshot::take();
+    if (input::is_key_pressed(KEY_F9)) snapshot::restore(snapshot::get_latest_id());
 }
 
 void update() {
+    input::begin_tick();
+
+    // the shop holds the original cargo and money of the deal and writes them
+    // back on cancel, which would undo a rollback made while it's open
     if (!shop::check_if_opened()) {
-        camera::update();
-        update_player_entering_port();
-        update_ships();
-        update_dynamic_bodies();
+        update_snapshots();
+        update_world();
     }
 
-    update_window_should_close();
+    TICK += 1;
 }
 
+// the two latest published states, as acquired by the render thread
+static const render_state::RenderState *PREV_STATE;
+static const render_state::RenderState *CURR_STATE;
+
 void draw_ports() {
     static float radius = 0.8;
 
@@ -160,17 +307,13 @@ void draw_ports() {
     renderer::set_game_camera(shader);
     BeginShaderMode(shader);
 
-    auto view = registry::registry.view<components::Transform, components::Port>();
-    for (auto entity : view) {
-        auto [transform, port] = view.get(entity);
-        DrawCircleV(transform.position, radius, RED);
-        DrawRing(
-            transform.position, port.radius, port.radius + 0.15, 0.0, 360.0, 32, RED
-        );
+    for (auto &port : CURR_STATE->ports) {
+        DrawCircleV(port.position, radius, RED);
+        DrawRing(port.position, port.radius, port.radius + 0.15, 0.0, 360.0, 32, RED);
     }
 }
 
-void draw_ships() {
+void draw_ships(float alpha) {
     static float height = 0.5;
     static float width = 1.0;
 
@@ -178,9 +321,12 @@ void draw_ships() {
     renderer::set_game_camera(shader);
     BeginShaderMode(shader);
 
-    auto view = registry::registry.view<components::Transform, ship::Ship>();
-    for (auto entity : view) {
-        auto [transform, ship] = view.get(entity);
+    bool is_matched = PREV_STATE->ships.size() == CURR_STATE->ships.size();
+    for (size_t i = 0; i < CURR_STATE->ships.size(); ++i) {
+        auto transform = CURR_STATE->ships[i];
+        if (is_matched) {
+            transform = render_state::interpolate(PREV_STATE->ships[i], transform, alpha);
+        }
 
         Vector2 origin = {0.5f * width, 0.5f * height};
         Rectangle rect = {
@@ -197,11 +343,8 @@ void draw_ships() {
 
 static std::vector<Vector2> PATH;
 void update_and_draw_debug() {
-    auto player_entity = registry::registry.view<components::Player>().front();
-    auto player_transform = registry::registry.get<components::Transform>(player_entity);
-
     if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) {
-        auto start = player_transform.position;
+        auto start = CURR_STATE->player_position;
         auto end = screen_to_world(GetMousePosition());
         PATH = terrain::get_path(start, end);
     }
@@ -209,22 +352,30 @@ void update_and_draw_debug() {
     Shader shader = resources::SPRITE_SHADER;
     renderer::set_game_camera(shader);
     BeginShaderMode(shader);
-    for (int i = 0; i < PATH.size(); i += 1) {
+    for (size_t i = 0; i < PATH.size(); i += 1) {
         DrawCircleV(PATH[i], 0.3, MAGENTA);
     }
     EndShaderMode();
 }
 
 void draw() {
+    // render one tick behind the simulation, between the two latest states
+    render_state::acquire(&PREV_STATE, &CURR_STATE);
+    float alpha = (get_time() - CURR_STATE->time) / DT;
+    alpha = std::clamp(alpha, 0.0f, 1.0f);
+
     BeginDrawing();
     ClearBackground(BLACK);
     ui::begin();
 
     terrain::draw();
     draw_ports();
-    draw_ships();
+    draw_ships(alpha);
 
-    shop::update_and_draw();
+    {
+        std::lock_guard<std::mutex> lock(WORLD_MUTEX);
+        shop::update_and_draw();
+    }
     profiler::draw();
 
     update_and_draw_debug();
@@ -232,14 +383,9 @@ void draw() {
     EndDrawing();
 }
 
-void load() {
-    renderer::load();
-    resources::load();
+void generate_world() {
     terrain::load();
-    ui::load();
-
     Vector2 terrain_center = terrain::get_world_center();
-    camera::set_target(terrain_center);
 
     // ---------------------------------------------------------------
     // create player
@@ -247,18 +393,35 @@ void load() {
         Vector2 position = terrain_center;
         position.x -= 8.0;
         position.y -= 10.0;
-        create_player(position);
+        PLAYER_ENTITY = spawn::create_player(position);
     }
 
     // ---------------------------------------------------------------
     // create NPCs
     {
         Vector2 position = terrain_center;
-        create_ship(position, ship::ControllerType::DUMMY);
+        spawn::create_ship(position, ship::ControllerType::DUMMY);
 
         position.x += 10.0;
         position.y += 5.0;
-        create_ship(position, ship::ControllerType::DUMMY);
+        spawn::create_ship(position, ship::ControllerType::DUMMY);
+    }
+
+    // ---------------------------------------------------------------
+    // create extra NPCs
+    if (N_EXTRA_NPCS > 0) {
+        int world_size = terrain::get_world_size();
+        std::vector<Vector2> positions(N_EXTRA_NPCS);
+        for (auto &position : positions) {
+            do {
+                position.x = world_size * (float)std::rand() / RAND_MAX;
+                position.y = world_size * (float)std::rand() / RAND_MAX;
+            } while (!terrain::check_if_water(position));
+        }
+
+        profiler::push("spawn_extra_npcs");
+        spawn::create_ships(positions, ship::ControllerType::DUMMY);
+        profiler::pop();
     }
 
     // ---------------------------------------------------------------
@@ -270,6 +433,7 @@ void load() {
 
         int n = 0;
         Vector2 candidates[size * size];
+        std::vector<Vector2> positions;
 
         // iterate on quadrants
         int terrain_size = terrain::get_world_size();
@@ -291,37 +455,254 @@ void load() {
                 // pick one candidate position from the quadrant
                 if (n > 0) {
                     int idx = std::rand() % n;
-                    Vector2 position = candidates[idx];
-                    create_port(position);
+                    positions.push_back(candidates[idx]);
                 }
             }
         }
+
+        spawn::create_ports(positions);
+    }
+
+    economy::load();
+    port_index::load();
+
+    profiler::push("load_routes");
+    routes::load();
+    profiler::pop();
+
+    // ---------------------------------------------------------------
+    // create NPC traders
+    if (N_TRADERS > 0) {
+        int n_ports = registry::get_ports_group().size();
+        std::vector<int> port_idxs(N_TRADERS);
+        for (auto &port_idx : port_idxs) {
+            port_idx = std::rand() % n_ports;
+        }
+
+        spawn::create_traders(port_idxs);
     }
+
+    // ---------------------------------------------------------------
+    // create NPC ferries
+    if (N_FERRIES > 0) {
+        int n_ports = registry::get_ports_group().size();
+        std::vector<int> port_idxs(N_FERRIES);
+        for (auto &port_idx : port_idxs) {
+            port_idx = std::rand() % n_ports;
+        }
+
+        spawn::create_ferries(port_idxs);
+    }
+}
+
+// Behaviour tasks aren't saved: ferries start over from their nearest port.
+void restart_ferries() {
+    using components::Transform;
+    using ship::Ship;
+
+    auto view = registry::registry.view<Ship, Transform>();
+    for (auto [entity, ship, transform] : view.each()) {
+        if (ship.controller_type != ship::ControllerType::FERRY) continue;
+
+        int port_idx;
+        if (port_index::find_nearest(transform.position, 1, &port_idx) == 0) continue;
+        ship.target_position = transform.position;
+        behaviour::start(behaviour::ferry(entity, port_idx));
+    }
+}
+
+void load_world() {
+    registry::load();
+    jobs::load();
+    load_systems();
+
+    bool is_loaded = !LOAD_PATH.empty();
+    if (is_loaded) {
+        profiler::push("load_save");
+        save::load(LOAD_PATH);
+        profiler::pop();
+        port_index::load();
+    } else {
+        generate_world();
+    }
+
+    PLAYER_ENTITY = registry::registry.view<components::Player>().front();
+    camera::set_target(terrain::get_world_center());
+    lod::set_view(camera::get_position(), camera::get_view_width());
+
+    port_zones::load();
+    port_zones::subscribe(on_port_zone_event);
+    order_book::load();
+    price_history::load(registry::get_ports_group().size());
+    trader::load();
+    if (is_loaded) restart_ferries();
+
+    snapshot::load(N_SNAPSHOTS);
+}
+
+void load() {
+    renderer::load();
+    resources::load();
+    ui::load();
+
+    load_world();
+    terrain::load_texture();
+}
+
+void save_world() {
+    if (SAVE_PATH.empty()) return;
+
+    profiler::push("save");
+    save::save(SAVE_PATH);
+    profiler::pop();
+}
+
+void unload_world() {
+    jobs::unload();
+    // the terrain may point into the mapped save
+    terrain::unload_data();
+    save::unload();
 }
 
 void unload() {
+    unload_world();
     ui::unload();
     terrain::unload();
     resources::unload();
     renderer::unload();
 }
 
+void update_npc_tick_divider(int n_steps, int n_dropped_steps) {
+    static int n_calm_frames = 0;
+
+    if (n_dropped_steps > 0) {
+        NPC_TICK_DIVIDER = std::min(2 * NPC_TICK_DIVIDER, MAX_NPC_TICK_DIVIDER);
+        n_calm_frames = 0;
+    } else if (n_steps <= 1 && ++n_calm_frames >= N_CALM_FRAMES_TO_RECOVER) {
+        NPC_TICK_DIVIDER = std::max(NPC_TICK_DIVIDER / 2, 1);
+        n_calm_frames = 0;
+    }
+}
+
+void run_simulation() {
+    double last_update_time = get_time();
+    while (!WINDOW_SHOULD_CLOSE) {
+        double time = get_time();
+
+        int n_steps = 0;
+        while (time - last_update_time >= DT && n_steps < MAX_N_STEPS_PER_FRAME) {
+            last_update_time += DT;
+            n_steps += 1;
+
+            std::lock_guard<std::mutex> lock(WORLD_MUTEX);
+            update();
+            render_state::publish(last_update_time);
+        }
+
+        // drop the rest of the backlog instead of spiraling into catch-up
+        int n_dropped_steps = (time - last_update_time) / DT;
+        if (n_dropped_steps > 0) {
+            double dropped_time = n_dropped_steps * DT;
+            last_update_time += dropped_time;
+            profiler::add_counter("sim.n_dropped_steps", n_dropped_steps);
+            profiler::add_counter("sim.dropped_time", dropped_time);
+        }
+
+        if (IS_NPC_TICK_RATE_ADAPTIVE) {
+            update_npc_tick_divider(n_steps, n_dropped_steps);
+            profiler::set_counter("sim.npc_tick_divider", NPC_TICK_DIVIDER);
+        }
+
+        double sleep_time = last_update_time + DT - get_time();
+        std::this_thread::sleep_for(std::chrono::duration<double>(sleep_time));
+    }
+}
+
 void run() {
     load();
+    render_state::publish(get_time());
 
-    float last_update_time = 0.0;
+    std::thread simulation_thread(run_simulation);
     while (!WINDOW_SHOULD_CLOSE) {
-        float time = GetTime();
+        input::update();
 
-        while (time - last_update_time >= DT) {
-            update();
-            last_update_time += DT;
+        bool is_shop_opened;
+        {
+            std::lock_guard<std::mutex> lock(WORLD_MUTEX);
+            is_shop_opened = shop::check_if_opened();
+        }
+        if (!is_shop_opened) {
+            camera::update();
+
+            std::lock_guard<std::mutex> lock(WORLD_MUTEX);
+            lod::set_view(camera::get_position(), camera::get_view_width());
         }
 
+        update_window_should_close();
         draw();
     }
+    simulation_thread.join();
+    save_world();
 
     unload();
 }
+
+void run_headless(int n_ticks) {
+    load_world();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n_ticks; ++i) {
+        update();
+    }
+    auto end = std::chrono::steady_clock::now();
+    save_world();
+
+    double elapsed = std::chrono::duration<double>(end - start).count();
+    double ticks_per_second = elapsed > 0.0 ? n_ticks / elapsed : 0.0;
+    printf("ticks        : %d\n", n_ticks);
+    printf("time         : %f\n", elapsed);
+    printf("ticks/second : %f\n", ticks_per_second);
+    profiler::print();
+
+    unload_world();
+}
+
+void set_n_extra_npcs(int n) {
+    N_EXTRA_NPCS = std::max(n, 0);
+}
+
+void set_n_traders(int n) {
+    N_TRADERS = std::max(n, 0);
+}
+
+void set_n_ferries(int n) {
+    N_FERRIES = std::max(n, 0);
+}
+
+void set_max_n_steps_per_frame(int n) {
+    MAX_N_STEPS_PER_FRAME = std::max(n, 1);
+}
+
+void set_npc_tick_rate_adaptive(bool is_adaptive) {
+    IS_NPC_TICK_RATE_ADAPTIVE = is_adaptive;
+    if (!is_adaptive) NPC_TICK_DIVIDER = 1;
+}
+
+void set_lod_enabled(bool is_enabled) {
+    lod::set_enabled(is_enabled);
+}
+
+void set_load_path(const std::string &path) {
+    LOAD_PATH = path;
+}
+
+void set_save_path(const std::string &path) {
+    SAVE_PATH = path;
+}
+
+void set_n_ticks_per_economy_update(int n) {
+    N_TICKS_PER_ECONOMY_UPDATE = std::max(n, 1);
+}
+
 }  // namespace game
 }  // namespace st
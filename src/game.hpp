@@ -1,9 +1,22 @@
 #pragma once
 
+#include <string>
+
 namespace st {
 namespace game {
 
 void run();
+void run_headless(int n_ticks);
+
+void set_n_extra_npcs(int n);
+void set_n_traders(int n);
+void set_n_ferries(int n);
+void set_max_n_steps_per_frame(int n);
+void set_npc_tick_rate_adaptive(bool is_adaptive);
+void set_lod_enabled(bool is_enabled);
+void set_n_ticks_per_economy_update(int n);
+void set_load_path(const std::string &path);
+void set_save_path(const std::string &path);
 
 }
 }  // namespace st
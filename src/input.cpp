@@ -0,0 +1,54 @@
+#include "input.hpp"
+
+#include "raylib/raylib.h"
+#include <array>
+#include <mutex>
+
+namespace st {
+namespace input {
+
+static std::mutex MUTEX;
+
+// pending state, written by update and set_key_down
+static std::array<bool, N_KEYS> IS_KEY_DOWN_PENDING;
+static std::array<bool, N_KEYS> IS_KEY_PRESSED_PENDING;
+
+// tick state, owned by the simulation
+static std::array<bool, N_KEYS> IS_KEY_DOWN;
+static std::array<bool, N_KEYS> IS_KEY_PRESSED;
+
+void update() {
+    std::lock_guard<std::mutex> lock(MUTEX);
+    for (int key = 0; key < N_KEYS; ++key) {
+        IS_KEY_DOWN_PENDING[key] = IsKeyDown(key);
+        IS_KEY_PRESSED_PENDING[key] |= IsKeyPressed(key);
+    }
+}
+
+void set_key_down(int key, bool is_down) {
+    if (key < 0 || key >= N_KEYS) return;
+
+    std::lock_guard<std::mutex> lock(MUTEX);
+    IS_KEY_PRESSED_PENDING[key] |= is_down && !IS_KEY_DOWN_PENDING[key];
+    IS_KEY_DOWN_PENDING[key] = is_down;
+}
+
+void begin_tick() {
+    std::lock_guard<std::mutex> lock(MUTEX);
+    IS_KEY_DOWN = IS_KEY_DOWN_PENDING;
+    IS_KEY_PRESSED = IS_KEY_PRESSED_PENDING;
+    IS_KEY_PRESSED_PENDING.fill(false);
+}
+
+bool is_key_down(int key) {
+    if (key < 0 || key >= N_KEYS) return false;
+    return IS_KEY_DOWN[key];
+}
+
+bool is_key_pressed(int key) {
+    if (key < 0 || key >= N_KEYS) return false;
+    return IS_KEY_PRESSED[key];
+}
+
+}  // namespace input
+}  // namespace st
@@ -0,0 +1,20 @@
+#pragma once
+
+namespace st {
+namespace input {
+
+static const int N_KEYS = 512;
+
+// Keyboard state seen by the simulation. The window build polls raylib into
+// a pending state every frame (render thread), the headless build leaves it
+// empty or scripts it with set_key_down. The simulation latches the pending
+// state at the start of each tick, so every key press is seen by one tick.
+void update();
+void set_key_down(int key, bool is_down);
+void begin_tick();
+
+bool is_key_down(int key);
+bool is_key_pressed(int key);
+
+}  // namespace input
+}  // namespace st
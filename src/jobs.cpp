@@ -0,0 +1,200 @@
+#include "jobs.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace st {
+namespace jobs {
+
+class Job {
+public:
+    std::function<void()> fn;
+    Handle handle;
+};
+
+class Queue {
+public:
+    std::mutex mutex;
+    std::deque<Job> jobs;
+};
+
+static std::vector<std::thread> WORKERS;
+static std::atomic<bool> IS_RUNNING = false;
+
+// one queue per worker, the last one is shared by non-worker threads
+static std::unique_ptr<Queue[]> QUEUES;
+static int N_QUEUES = 0;
+static thread_local int QUEUE_IDX = -1;
+
+static std::atomic<int> N_QUEUED = 0;
+static std::mutex SLEEP_MUTEX;
+static std::condition_variable SLEEP_CV;
+
+Handle::Handle()
+    : n_pending(std::make_shared<std::atomic<int>>(0)) {}
+
+bool Handle::check_if_done() const {
+    return *this->n_pending == 0;
+}
+
+void push(Job job) {
+    int idx = QUEUE_IDX >= 0 ? QUEUE_IDX : N_QUEUES - 1;
+    {
+        std::lock_guard<std::mutex> lock(QUEUES[idx].mutex);
+        QUEUES[idx].jobs.push_back(std::move(job));
+    }
+
+    N_QUEUED += 1;
+    { std::lock_guard<std::mutex> lock(SLEEP_MUTEX); }
+    SLEEP_CV.notify_one();
+}
+
+bool try_pop(Job *job) {
+    // own queue, newest first
+    if (QUEUE_IDX >= 0) {
+        auto &queue = QUEUES[QUEUE_IDX];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            *job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            N_QUEUED -= 1;
+            return true;
+        }
+    }
+
+    // steal from the others, oldest first
+    int start_idx = QUEUE_IDX + 1;
+    for (int i = 0; i < N_QUEUES; ++i) {
+        int idx = (start_idx + i) % N_QUEUES;
+        if (idx == QUEUE_IDX) continue;
+
+        auto &queue = QUEUES[idx];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            *job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            N_QUEUED -= 1;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void execute(Job &job) {
+    job.fn();
+    if (--*job.handle.n_pending > 0) return;
+
+    // the last job of the handle wakes up whoever waits for it
+    { std::lock_guard<std::mutex> lock(SLEEP_MUTEX); }
+    SLEEP_CV.notify_all();
+}
+
+void run_worker(int idx) {
+    QUEUE_IDX = idx;
+
+    Job job;
+    while (IS_RUNNING) {
+        if (try_pop(&job)) {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(SLEEP_MUTEX);
+        SLEEP_CV.wait(lock, [] { return N_QUEUED > 0 || !IS_RUNNING; });
+    }
+}
+
+void load() {
+    load(std::max((int)std::thread::hardware_concurrency() - 1, 0));
+}
+
+void load(int n_workers) {
+    N_QUEUES = n_workers + 1;
+    QUEUES = std::make_unique<Queue[]>(N_QUEUES);
+    IS_RUNNING = true;
+    for (int i = 0; i < n_workers; ++i) {
+        WORKERS.emplace_back(run_worker, i);
+    }
+}
+
+void unload() {
+    {
+        std::lock_guard<std::mutex> lock(SLEEP_MUTEX);
+        IS_RUNNING = false;
+    }
+    SLEEP_CV.notify_all();
+
+    for (auto &worker : WORKERS) {
+        worker.join();
+    }
+    WORKERS.clear();
+    QUEUES.reset();
+    N_QUEUES = 0;
+    N_QUEUED = 0;
+}
+
+int get_n_workers() {
+    return WORKERS.size();
+}
+
+Handle submit(std::function<void()> fn) {
+    Handle handle;
+    submit(fn, handle);
+    return handle;
+}
+
+void submit(std::function<void()> fn, Handle handle) {
+    if (WORKERS.empty()) {
+        fn();
+        return;
+    }
+
+    *handle.n_pending += 1;
+    push({std::move(fn), handle});
+}
+
+void wait(Handle handle) {
+    Job job;
+    while (!handle.check_if_done()) {
+        if (try_pop(&job)) {
+            execute(job);
+            continue;
+        }
+
+        // the remaining jobs are running on other threads: sleep until one of
+        // them finishes the handle or queues more work to help with
+        std::unique_lock<std::mutex> lock(SLEEP_MUTEX);
+        SLEEP_CV.wait(lock, [&handle] {
+            return handle.check_if_done() || N_QUEUED > 0;
+        });
+    }
+}
+
+void parallel_for(
+    int begin, int end, int grain_size, const std::function<void(int, int)> &fn
+) {
+    grain_size = std::max(grain_size, 1);
+    if (end - begin <= grain_size || WORKERS.empty()) {
+        if (end > begin) fn(begin, end);
+        return;
+    }
+
+    // the first chunk is executed by the caller
+    Handle handle;
+    for (int chunk_begin = begin + grain_size; chunk_begin < end;
+         chunk_begin += grain_size) {
+        int chunk_end = std::min(chunk_begin + grain_size, end);
+        submit([&fn, chunk_begin, chunk_end] { fn(chunk_begin, chunk_end); }, handle);
+    }
+    fn(begin, begin + grain_size);
+
+    wait(handle);
+}
+
+}  // namespace jobs
+}  // namespace st
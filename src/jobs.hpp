@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace st {
+namespace jobs {
+
+// Shared completion counter of one or more submitted jobs.
+class Handle {
+public:
+    std::shared_ptr<std::atomic<int>> n_pending;
+
+    Handle();
+
+    bool check_if_done() const;
+};
+
+// Starts one worker per hardware thread (minus the caller). Every worker
+// owns a deque: it pops its own jobs newest first and steals the oldest jobs
+// of the others when it runs dry. Without workers jobs run inline.
+void load();
+void load(int n_workers);
+void unload();
+int get_n_workers();
+
+Handle submit(std::function<void()> fn);
+void submit(std::function<void()> fn, Handle handle);
+
+// Executes pending jobs on the calling thread until the handle is done, then
+// sleeps if the rest of them are still running elsewhere.
+void wait(Handle handle);
+
+// Splits [begin, end) into chunks of grain_size and calls fn(chunk_begin,
+// chunk_end) for each of them in parallel. Returns when all chunks are done.
+void parallel_for(
+    int begin, int end, int grain_size, const std::function<void(int, int)> &fn
+);
+
+}  // namespace jobs
+}  // namespace st
@@ -0,0 +1,34 @@
+#include "knapsack.hpp"
+
+#include "cargo.hpp"
+#include "components.hpp"
+#include <array>
+
+namespace st {
+namespace knapsack {
+
+Solution<cargo::N_PRODUCTS> get_best_cargo(
+    const cargo::Cargo &ship_cargo,
+    int money,
+    const components::Port &from_port,
+    const components::Port &to_port
+) {
+    std::array<Item, cargo::N_PRODUCTS> items;
+    for (int p = 0; p < cargo::N_PRODUCTS; ++p) {
+        auto product_id = (cargo::ProductID)p;
+        int buy_price = from_port.prices.get_sell_price(product_id);
+        int sell_price = to_port.prices.get_buy_price(product_id);
+
+        items[p] = {
+            .weight = cargo::get_product(product_id).unit_weight,
+            .price = buy_price,
+            .profit = sell_price - buy_price,
+            .max_n = from_port.cargo.get_n_units(product_id),
+        };
+    }
+
+    return solve<cargo::N_PRODUCTS>(items, ship_cargo.get_free_weight(), money);
+}
+
+}  // namespace knapsack
+}  // namespace st
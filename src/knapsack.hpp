@@ -0,0 +1,136 @@
+#pragma once
+
+#include "cargo.hpp"
+#include "components.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace st {
+namespace knapsack {
+
+// the weight axis of the table is scaled down to at most this many steps
+static const int MAX_N_WEIGHT_STEPS = 1024;
+
+// Per-unit values of one kind of item.
+class Item {
+public:
+    int weight;
+    int price;
+    int profit;
+    int max_n;
+};
+
+template <int N>
+class Solution {
+public:
+    std::array<int, N> n_units = {};
+    int profit = 0;
+    int cost = 0;
+};
+
+// Bounded knapsack over N item kinds with integer weights: maximizes the
+// profit of the picked units within the capacity (weight) and the money
+// (price). Bounded counts are split into power-of-two chunks and solved as
+// a 0/1 knapsack with one table column per weight step. Each column keeps
+// its cheapest best profit and money is checked on every transition, so
+// the result always fits both limits, but it can miss the optimum when
+// money is the tighter one.
+template <int N>
+Solution<N> solve(const std::array<Item, N> &items, int capacity, int money) {
+    class Chunk {
+    public:
+        int item_idx;
+        int n;
+        int weight;
+        int cost;
+        int profit;
+    };
+
+    // reused by every solve on the thread
+    static thread_local std::vector<Chunk> chunks;
+    static thread_local std::vector<int> profits;
+    static thread_local std::vector<int> costs;
+    static thread_local std::vector<uint8_t> keeps;
+
+    Solution<N> solution;
+    if (capacity <= 0 || money < 0) return solution;
+
+    int scale = (capacity + MAX_N_WEIGHT_STEPS - 1) / MAX_N_WEIGHT_STEPS;
+    int n_steps = capacity / scale;
+
+    chunks.clear();
+    for (int i = 0; i < N; ++i) {
+        const Item &item = items[i];
+        if (item.profit <= 0 || item.weight <= 0) continue;
+
+        int max_n = std::min(item.max_n, capacity / item.weight);
+        if (item.price > 0) max_n = std::min(max_n, money / item.price);
+
+        for (int n = 1; max_n > 0; n *= 2) {
+            n = std::min(n, max_n);
+            max_n -= n;
+
+            // rounded up, so the scaled weights never overflow the capacity
+            int weight = (n * item.weight + scale - 1) / scale;
+            chunks.push_back(
+                {.item_idx = i,
+                 .n = n,
+                 .weight = weight,
+                 .cost = n * item.price,
+                 .profit = n * item.profit}
+            );
+        }
+    }
+
+    int n_cols = n_steps + 1;
+    profits.assign(n_cols, 0);
+    costs.assign(n_cols, 0);
+    keeps.assign(chunks.size() * n_cols, 0);
+
+    for (int c = 0; c < (int)chunks.size(); ++c) {
+        const Chunk &chunk = chunks[c];
+        uint8_t *keep = &keeps[c * n_cols];
+
+        for (int w = n_steps; w >= chunk.weight; --w) {
+            int profit = profits[w - chunk.weight] + chunk.profit;
+            int cost = costs[w - chunk.weight] + chunk.cost;
+            if (cost > money) continue;
+
+            bool is_better = profit > profits[w]
+                             || (profit == profits[w] && cost < costs[w]);
+            if (!is_better) continue;
+
+            profits[w] = profit;
+            costs[w] = cost;
+            keep[w] = 1;
+        }
+    }
+
+    // walk the chunks back from the full capacity
+    int w = n_steps;
+    for (int c = (int)chunks.size() - 1; c >= 0; --c) {
+        if (!keeps[c * n_cols + w]) continue;
+
+        const Chunk &chunk = chunks[c];
+        solution.n_units[chunk.item_idx] += chunk.n;
+        solution.profit += chunk.profit;
+        solution.cost += chunk.cost;
+        w -= chunk.weight;
+    }
+
+    return solution;
+}
+
+// The cargo mix to buy at one port and sell at the other which makes the
+// most money, within the ship's free weight and money.
+Solution<cargo::N_PRODUCTS> get_best_cargo(
+    const cargo::Cargo &ship_cargo,
+    int money,
+    const components::Port &from_port,
+    const components::Port &to_port
+);
+
+}  // namespace knapsack
+}  // namespace st
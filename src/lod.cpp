@@ -0,0 +1,100 @@
+#include "lod.hpp"
+
+#include "components.hpp"
+#include "jobs.hpp"
+#include "profiler.hpp"
+#include "raylib/raylib.h"
+#include "raylib/raymath.h"
+#include "registry.hpp"
+#include "ship.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <vector>
+
+namespace st {
+namespace lod {
+
+static const int SHIPS_GRAIN_SIZE = 4096;
+
+// ships within PLAYER_RADIUS of the player or inside the view are FULL, each
+// next tier starts at twice the distance of the previous one
+static const float PLAYER_RADIUS = 25.0;
+
+// fraction of the view width covering the screen corners at the usual aspects
+static const float VIEW_RADIUS_SCALE = 0.6;
+
+static const std::array<int, 5> TICK_DIVIDERS = {1, 2, 4, 8, 8};
+
+static Vector2 VIEW_CENTER = {0.0, 0.0};
+static float VIEW_RADIUS = PLAYER_RADIUS;
+static bool IS_ENABLED = true;
+
+static std::vector<Tier> TIERS;
+
+void set_view(Vector2 center, float width) {
+    VIEW_CENTER = center;
+    VIEW_RADIUS = VIEW_RADIUS_SCALE * width;
+}
+
+Tier get_tier(Vector2 position, Vector2 player_position, bool is_routed) {
+    // distance in units of the visible radius, to the closest of the two
+    float view_dist = Vector2Distance(position, VIEW_CENTER) / VIEW_RADIUS;
+    float player_dist = Vector2Distance(position, player_position) / PLAYER_RADIUS;
+    float dist = std::min(view_dist, player_dist);
+
+    if (dist < 1.0) return Tier::FULL;
+    if (dist < 2.0) return Tier::HALF;
+    if (dist < 4.0) return Tier::QUARTER;
+    return is_routed ? Tier::ANALYTIC : Tier::EIGHTH;
+}
+
+void update(Vector2 player_position) {
+    auto group = registry::get_ships_group();
+    auto transforms = group.storage<components::Transform>()->rbegin();
+    auto ships = group.storage<ship::Ship>()->rbegin();
+    int n_ships = group.size();
+
+    TIERS.resize(n_ships);
+    if (!IS_ENABLED) {
+        std::fill(TIERS.begin(), TIERS.end(), Tier::FULL);
+        return;
+    }
+
+    std::array<std::atomic<int>, TICK_DIVIDERS.size()> n_ships_per_tier = {};
+    jobs::parallel_for(0, n_ships, SHIPS_GRAIN_SIZE, [&](int begin, int end) {
+        std::array<int, TICK_DIVIDERS.size()> counts = {};
+        for (int i = begin; i < end; ++i) {
+            // traders and ferries alike steer along route paths
+            auto controller_type = ships[i].controller_type;
+            bool is_routed = controller_type == ship::ControllerType::TRADER
+                             || controller_type == ship::ControllerType::FERRY;
+            TIERS[i] = get_tier(transforms[i].position, player_position, is_routed);
+            counts[(int)TIERS[i]] += 1;
+        }
+
+        for (size_t t = 0; t < counts.size(); ++t) n_ships_per_tier[t] += counts[t];
+    });
+
+    profiler::set_counter("lod.n_full", n_ships_per_tier[(int)Tier::FULL]);
+    profiler::set_counter("lod.n_half", n_ships_per_tier[(int)Tier::HALF]);
+    profiler::set_counter("lod.n_quarter", n_ships_per_tier[(int)Tier::QUARTER]);
+    profiler::set_counter("lod.n_eighth", n_ships_per_tier[(int)Tier::EIGHTH]);
+    profiler::set_counter("lod.n_analytic", n_ships_per_tier[(int)Tier::ANALYTIC]);
+}
+
+void set_enabled(bool is_enabled) {
+    IS_ENABLED = is_enabled;
+}
+
+int get_tick_divider(int ship_idx) {
+    if (ship_idx >= (int)TIERS.size()) return 1;
+    return TICK_DIVIDERS[(int)TIERS[ship_idx]];
+}
+
+bool check_if_analytic(int ship_idx) {
+    return ship_idx < (int)TIERS.size() && TIERS[ship_idx] == Tier::ANALYTIC;
+}
+
+}  // namespace lod
+}  // namespace st
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "raylib/raylib.h"
+#include <cstdint>
+
+namespace st {
+namespace lod {
+
+// How often a ship is simulated, by its distance to the player and the view.
+// Also the scheduler resource which guards the tier assignments.
+enum class Tier : uint8_t {
+    FULL,
+    HALF,
+    QUARTER,
+    EIGHTH,
+    // an off-screen ship following a route path (a trader or a ferry):
+    // every 8th tick, moved straight along the path without physics
+    // (ship::Ship::advance)
+    ANALYTIC,
+};
+
+// The part of the world the player is looking at, set from the render thread.
+void set_view(Vector2 center, float width);
+
+// Reassigns the tiers of all ships (indexed as the ships group). Cheap
+// enough to run every second or so, ships spawned in between are FULL.
+void update(Vector2 player_position);
+
+void set_enabled(bool is_enabled);
+
+// Number of ticks between two updates of the ship (1, 2, 4 or 8).
+int get_tick_divider(int ship_idx);
+bool check_if_analytic(int ship_idx);
+
+}  // namespace lod
+}  // namespace st
@@ -1,5 +1,41 @@
 #include "game.hpp"
 
-int main() {
-    st::game::run();
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char **argv) {
+    // usage: sea_trader [--headless N_TICKS] [--npcs N] [--max-steps N] [--adaptive]
+    //                   [--economy-ticks N] [--traders N] [--ferries N]
+    //                   [--no-lod] [--load PATH] [--save PATH]
+    int n_headless_ticks = 0;
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            n_headless_ticks = has_value ? std::atoi(argv[++i]) : 10000;
+        } else if (std::strcmp(argv[i], "--npcs") == 0 && has_value) {
+            st::game::set_n_extra_npcs(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--traders") == 0 && has_value) {
+            st::game::set_n_traders(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--ferries") == 0 && has_value) {
+            st::game::set_n_ferries(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--max-steps") == 0 && has_value) {
+            st::game::set_max_n_steps_per_frame(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--adaptive") == 0) {
+            st::game::set_npc_tick_rate_adaptive(true);
+        } else if (std::strcmp(argv[i], "--no-lod") == 0) {
+            st::game::set_lod_enabled(false);
+        } else if (std::strcmp(argv[i], "--load") == 0 && has_value) {
+            st::game::set_load_path(argv[++i]);
+        } else if (std::strcmp(argv[i], "--save") == 0 && has_value) {
+            st::game::set_save_path(argv[++i]);
+        } else if (std::strcmp(argv[i], "--economy-ticks") == 0 && has_value) {
+            st::game::set_n_ticks_per_economy_update(std::atoi(argv[++i]));
+        }
+    }
+
+    if (n_headless_ticks > 0) {
+        st::game::run_headless(n_headless_ticks);
+    } else {
+        st::game::run();
+    }
 }
@@ -0,0 +1,365 @@
+#include "order_book.hpp"
+
+#include "cargo.hpp"
+#include "components.hpp"
+#include "entt/entity/fwd.hpp"
+#include "entt/entt.hpp"
+#include "registry.hpp"
+#include "ship.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace st {
+namespace order_book {
+
+// max units a port offers or asks for per quote, i.e. per match; it's all
+// the NPC traders at the port can trade in one economy tick
+static const int MAX_PORT_QUOTE_N_UNITS = 1000;
+
+static const OrderID NULL_ORDER_ID = UINT64_MAX;
+
+// Order node of the pool. Orders of one price level form a doubly linked
+// FIFO list (time priority) through prev/next slot indices.
+class Order {
+public:
+    entt::entity trader;
+    int book_idx;
+    Side side;
+    int price;
+    int n_units = 0;
+    uint64_t seq;
+    uint32_t generation = 0;
+    int prev;
+    int next;
+};
+
+class PriceLevel {
+public:
+    int price;
+    int head;
+    int tail;
+};
+
+// Price levels of both sides, sorted so that the best price is at the back:
+// bids ascending, asks descending.
+class Book {
+public:
+    std::vector<PriceLevel> bids;
+    std::vector<PriceLevel> asks;
+    OrderID port_bid_id = NULL_ORDER_ID;
+    OrderID port_ask_id = NULL_ORDER_ID;
+};
+
+static std::vector<Order> ORDERS;
+static std::vector<int> FREE_SLOTS;
+static std::vector<Book> BOOKS;
+static std::vector<entt::entity> PORT_ENTITIES;
+static std::vector<Fill> FILLS;
+// NEXT_MATCH orders submitted since the last match
+static std::vector<OrderID> NEXT_MATCH_ORDER_IDS;
+static uint64_t SEQ = 0;
+
+int get_book_idx(int port_idx, cargo::ProductID product_id) {
+    return port_idx * cargo::N_PRODUCTS + (int)product_id;
+}
+
+int get_book_idx(entt::entity port_entity, cargo::ProductID product_id) {
+    return get_book_idx(registry::get_port_idx(port_entity), product_id);
+}
+
+OrderID get_order_id(int slot) {
+    return ((OrderID)ORDERS[slot].generation << 32) | (uint32_t)slot;
+}
+
+// Slot of a live order, -1 if the order is already gone.
+int get_slot(OrderID order_id) {
+    if (order_id == NULL_ORDER_ID) return -1;
+
+    int slot = order_id & UINT32_MAX;
+    uint32_t generation = order_id >> 32;
+    if (slot >= (int)ORDERS.size()) return -1;
+
+    Order &order = ORDERS[slot];
+    if (order.generation != generation || order.n_units == 0) return -1;
+    return slot;
+}
+
+std::vector<PriceLevel> &get_levels(Book &book, Side side) {
+    return side == Side::BID ? book.bids : book.asks;
+}
+
+// Position of the price level in the levels sorted best-last.
+std::vector<PriceLevel>::iterator find_level(
+    std::vector<PriceLevel> &levels, Side side, int price
+) {
+    return std::lower_bound(
+        levels.begin(),
+        levels.end(),
+        price,
+        [side](const PriceLevel &level, int price) {
+            return side == Side::BID ? level.price < price : level.price > price;
+        }
+    );
+}
+
+void link_order(int slot) {
+    Order &order = ORDERS[slot];
+    auto &levels = get_levels(BOOKS[order.book_idx], order.side);
+    auto level = find_level(levels, order.side, order.price);
+
+    order.next = -1;
+    if (level == levels.end() || level->price != order.price) {
+        order.prev = -1;
+        levels.insert(level, {.price = order.price, .head = slot, .tail = slot});
+    } else {
+        order.prev = level->tail;
+        ORDERS[level->tail].next = slot;
+        level->tail = slot;
+    }
+}
+
+void unlink_order(int slot) {
+    Order &order = ORDERS[slot];
+    auto &levels = get_levels(BOOKS[order.book_idx], order.side);
+    auto level = find_level(levels, order.side, order.price);
+
+    if (order.prev != -1) ORDERS[order.prev].next = order.next;
+    else level->head = order.next;
+    if (order.next != -1) ORDERS[order.next].prev = order.prev;
+    else level->tail = order.prev;
+
+    if (level->head == -1) levels.erase(level);
+}
+
+void free_order(int slot) {
+    Order &order = ORDERS[slot];
+    order.n_units = 0;
+    order.generation += 1;
+    FREE_SLOTS.push_back(slot);
+}
+
+void remove_order(int slot) {
+    unlink_order(slot);
+    free_order(slot);
+}
+
+int add_order(
+    entt::entity trader, int book_idx, Side side, int price, int n_units
+) {
+    int slot;
+    if (FREE_SLOTS.empty()) {
+        slot = ORDERS.size();
+        ORDERS.emplace_back();
+    } else {
+        slot = FREE_SLOTS.back();
+        FREE_SLOTS.pop_back();
+    }
+
+    Order &order = ORDERS[slot];
+    order.trader = trader;
+    order.book_idx = book_idx;
+    order.side = side;
+    order.price = price;
+    order.n_units = n_units;
+    order.seq = SEQ++;
+
+    link_order(slot);
+    return slot;
+}
+
+OrderID submit_order(
+    entt::entity trader,
+    entt::entity port_entity,
+    cargo::ProductID product_id,
+    Side side,
+    int price,
+    int n_units,
+    TimeInForce time_in_force
+) {
+    if (n_units <= 0) return NULL_ORDER_ID;
+
+    int book_idx = get_book_idx(port_entity, product_id);
+    int slot = add_order(trader, book_idx, side, price, n_units);
+    OrderID order_id = get_order_id(slot);
+    if (time_in_force == TimeInForce::NEXT_MATCH) {
+        NEXT_MATCH_ORDER_IDS.push_back(order_id);
+    }
+
+    return order_id;
+}
+
+void cancel_order(OrderID order_id) {
+    int slot = get_slot(order_id);
+    if (slot != -1) remove_order(slot);
+}
+
+int get_n_units_left(OrderID order_id) {
+    int slot = get_slot(order_id);
+    return slot == -1 ? 0 : ORDERS[slot].n_units;
+}
+
+int get_best_price(entt::entity port_entity, cargo::ProductID product_id, Side side) {
+    auto &levels = get_levels(BOOKS[get_book_idx(port_entity, product_id)], side);
+    return levels.empty() ? 0 : levels.back().price;
+}
+
+int get_best_bid(entt::entity port_entity, cargo::ProductID product_id) {
+    return get_best_price(port_entity, product_id, Side::BID);
+}
+
+int get_best_ask(entt::entity port_entity, cargo::ProductID product_id) {
+    return get_best_price(port_entity, product_id, Side::ASK);
+}
+
+cargo::Cargo &get_cargo(entt::entity trader) {
+    auto ship = registry::registry.try_get<ship::Ship>(trader);
+    if (ship) return ship->cargo;
+    return registry::registry.get<components::Port>(trader).cargo;
+}
+
+// Keeps the port's own quote in the book: updated in place (keeping its
+// time priority) while the price holds, re-submitted when it moves.
+void update_port_quote(
+    OrderID &order_id, entt::entity port_entity, int book_idx, Side side, int price, int n
+) {
+    int slot = get_slot(order_id);
+    if (slot != -1 && (ORDERS[slot].price != price || n <= 0)) {
+        remove_order(slot);
+        slot = -1;
+    }
+
+    if (slot != -1) {
+        ORDERS[slot].n_units = n;
+    } else if (n > 0) {
+        slot = add_order(port_entity, book_idx, side, price, n);
+    }
+
+    order_id = slot == -1 ? NULL_ORDER_ID : get_order_id(slot);
+}
+
+void update_port_quotes() {
+    for (int i = 0; i < (int)PORT_ENTITIES.size(); ++i) {
+        entt::entity port_entity = PORT_ENTITIES[i];
+        auto &port = registry::registry.get<components::Port>(port_entity);
+        auto &money = registry::registry.get<components::Money>(port_entity);
+
+        for (int p = 0; p < cargo::N_PRODUCTS; ++p) {
+            auto product_id = (cargo::ProductID)p;
+            int unit_weight = cargo::get_product(product_id).unit_weight;
+            int book_idx = get_book_idx(i, product_id);
+            Book &book = BOOKS[book_idx];
+
+            // keep the port's own quotes from crossing after price rounding
+            int bid_price = port.prices.get_buy_price(product_id);
+            int ask_price = port.prices.get_sell_price(product_id);
+            ask_price = std::max(ask_price, bid_price + 1);
+
+            int ask_n = port.cargo.get_n_units(product_id);
+            ask_n = std::min(ask_n, MAX_PORT_QUOTE_N_UNITS);
+            update_port_quote(
+                book.port_ask_id, port_entity, book_idx, Side::ASK, ask_price, ask_n
+            );
+
+            int bid_n = port.cargo.get_free_weight() / unit_weight;
+            if (bid_price > 0) bid_n = std::min(bid_n, money.value / bid_price);
+            bid_n = std::min(bid_n, MAX_PORT_QUOTE_N_UNITS);
+            update_port_quote(
+                book.port_bid_id, port_entity, book_idx, Side::BID, bid_price, bid_n
+            );
+        }
+    }
+}
+
+void load() {
+    auto group = registry::get_ports_group();
+    auto entities = group.storage<components::Port>()->data();
+
+    PORT_ENTITIES.assign(entities, entities + group.size());
+    BOOKS.assign(PORT_ENTITIES.size() * cargo::N_PRODUCTS, Book());
+    ORDERS.clear();
+    FREE_SLOTS.clear();
+    FILLS.clear();
+    NEXT_MATCH_ORDER_IDS.clear();
+
+    // traders quote against the ports from the start, not after a match
+    update_port_quotes();
+}
+
+void match_book(int book_idx) {
+    Book &book = BOOKS[book_idx];
+    entt::entity port_entity = PORT_ENTITIES[book_idx / cargo::N_PRODUCTS];
+    auto product_id = (cargo::ProductID)(book_idx % cargo::N_PRODUCTS);
+    int unit_weight = cargo::get_product(product_id).unit_weight;
+
+    while (!book.bids.empty() && !book.asks.empty()) {
+        int bid_slot = book.bids.back().head;
+        int ask_slot = book.asks.back().head;
+        Order &bid = ORDERS[bid_slot];
+        Order &ask = ORDERS[ask_slot];
+        if (bid.price < ask.price) break;
+
+        // self-trade prevention: the newer order is cancelled
+        if (bid.trader == ask.trader) {
+            remove_order(bid.seq > ask.seq ? bid_slot : ask_slot);
+            continue;
+        }
+
+        int price = bid.seq < ask.seq ? bid.price : ask.price;
+        int n = std::min(bid.n_units, ask.n_units);
+
+        // a side which can't honor its order anymore gets it cancelled
+        auto &seller_cargo = get_cargo(ask.trader);
+        auto &buyer_cargo = get_cargo(bid.trader);
+        auto &seller_money = registry::registry.get<components::Money>(ask.trader);
+        auto &buyer_money = registry::registry.get<components::Money>(bid.trader);
+
+        int seller_n = std::min(n, seller_cargo.get_n_units(product_id));
+        int buyer_n = std::min(n, buyer_cargo.get_free_weight() / unit_weight);
+        if (price > 0) buyer_n = std::min(buyer_n, buyer_money.value / price);
+        int n_settled = std::max(std::min(seller_n, buyer_n), 0);
+
+        if (n_settled > 0) {
+            seller_cargo.remove_units(product_id, n_settled);
+            buyer_cargo.add_units(product_id, n_settled);
+            seller_money.value += n_settled * price;
+            buyer_money.value -= n_settled * price;
+
+            FILLS.push_back(
+                {.buyer = bid.trader,
+                 .seller = ask.trader,
+                 .port_entity = port_entity,
+                 .product_id = product_id,
+                 .price = price,
+                 .n_units = n_settled}
+            );
+        }
+
+        bid.n_units = buyer_n < n ? 0 : bid.n_units - n_settled;
+        ask.n_units = seller_n < n ? 0 : ask.n_units - n_settled;
+        if (bid.n_units == 0) remove_order(bid_slot);
+        if (ask.n_units == 0) remove_order(ask_slot);
+    }
+}
+
+void match() {
+    FILLS.clear();
+    update_port_quotes();
+
+    for (int i = 0; i < (int)BOOKS.size(); ++i) {
+        match_book(i);
+    }
+
+    // filled orders are gone already, their ids don't resolve
+    for (OrderID order_id : NEXT_MATCH_ORDER_IDS) {
+        cancel_order(order_id);
+    }
+    NEXT_MATCH_ORDER_IDS.clear();
+}
+
+const std::vector<Fill> &get_fills() {
+    return FILLS;
+}
+
+}  // namespace order_book
+}  // namespace st
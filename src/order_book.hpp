@@ -0,0 +1,74 @@
+#pragma once
+
+#include "cargo.hpp"
+#include "entt/entity/fwd.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace st {
+namespace order_book {
+
+enum class Side {
+    BID,  // buy
+    ASK,  // sell
+};
+
+// How long an order rests in the book.
+enum class TimeInForce {
+    // until it's filled or cancelled
+    GOOD_TILL_CANCELLED,
+    // takes part in the next match only, what's left of it is cancelled then
+    NEXT_MATCH,
+};
+
+// Order ids stay unique: a slot of a filled or cancelled order gets reused
+// under a new id.
+using OrderID = uint64_t;
+
+// A matched part of two orders, settled at the price of the older one.
+class Fill {
+public:
+    entt::entity buyer;
+    entt::entity seller;
+    entt::entity port_entity;
+    cargo::ProductID product_id;
+    int price;
+    int n_units;
+};
+
+// One book per port and product for the ports that exist at the moment
+// (call it after the ports are spawned and priced), with the ports' quotes.
+void load();
+
+// Places a limit order of a trader (ship) into the book of the port and
+// product.
+OrderID submit_order(
+    entt::entity trader,
+    entt::entity port_entity,
+    cargo::ProductID product_id,
+    Side side,
+    int price,
+    int n_units,
+    TimeInForce time_in_force
+);
+void cancel_order(OrderID order_id);
+
+// Remaining (not yet filled) units of the order, 0 if it's gone.
+int get_n_units_left(OrderID order_id);
+
+// Best prices in the book as of now, 0 if the side is empty. The port's own
+// quotes are refreshed by match.
+int get_best_bid(entt::entity port_entity, cargo::ProductID product_id);
+int get_best_ask(entt::entity port_entity, cargo::ProductID product_id);
+
+// Refreshes the ports' own quotes from their current prices and stock,
+// then matches every book with price-time priority and settles the trades:
+// the units and the money move between the cargos and the Money components
+// of the two sides. Runs once per economy tick, after the economy update.
+void match();
+
+// Fills of the last match.
+const std::vector<Fill> &get_fills();
+
+}  // namespace order_book
+}  // namespace st
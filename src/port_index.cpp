@@ -0,0 +1,171 @@
+#include "port_index.hpp"
+
+#include "components.hpp"
+#include "raylib/raylib.h"
+#include "raylib/raymath.h"
+#include "registry.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace st {
+namespace port_index {
+
+// the cell size is picked to have about this many ports per cell
+static const float N_PORTS_PER_CELL = 2.0;
+
+// Grid in compressed form: ports of cell c are PORT_IDXS[CELL_STARTS[c]] up
+// to PORT_IDXS[CELL_STARTS[c + 1]], their positions are aligned with them.
+static Vector2 ORIGIN;
+static float CELL_SIZE;
+static int N_COLS = 0;
+static int N_ROWS = 0;
+static std::vector<int> CELL_STARTS;
+static std::vector<int> PORT_IDXS;
+static std::vector<Vector2> POSITIONS;
+static float MAX_PORT_RADIUS = 0.0;
+
+int get_col(float x) {
+    int col = std::floor((x - ORIGIN.x) / CELL_SIZE);
+    return std::clamp(col, 0, N_COLS - 1);
+}
+
+int get_row(float y) {
+    int row = std::floor((y - ORIGIN.y) / CELL_SIZE);
+    return std::clamp(row, 0, N_ROWS - 1);
+}
+
+void load() {
+    auto group = registry::get_ports_group();
+    auto ports = group.storage<components::Port>()->rbegin();
+    int n_ports = group.size();
+
+    std::vector<Vector2> positions(n_ports);
+    for (int i = 0; i < n_ports; ++i) {
+        auto entity = registry::get_port_entity(i);
+        positions[i] = registry::registry.get<components::Transform>(entity).position;
+    }
+
+    // bounds of the ports
+    Vector2 min = {FLT_MAX, FLT_MAX};
+    Vector2 max = {-FLT_MAX, -FLT_MAX};
+    MAX_PORT_RADIUS = 0.0;
+    for (int i = 0; i < n_ports; ++i) {
+        Vector2 position = positions[i];
+        min = Vector2Min(min, position);
+        max = Vector2Max(max, position);
+        MAX_PORT_RADIUS = std::max(MAX_PORT_RADIUS, ports[i].radius);
+    }
+
+    if (n_ports == 0) min = max = {0.0, 0.0};
+    float area = std::max((max.x - min.x) * (max.y - min.y), 1.0f);
+    ORIGIN = min;
+    CELL_SIZE = std::sqrt(area * N_PORTS_PER_CELL / std::max(n_ports, 1));
+    CELL_SIZE = std::max(CELL_SIZE, 1.0f);
+    N_COLS = (max.x - min.x) / CELL_SIZE + 1;
+    N_ROWS = (max.y - min.y) / CELL_SIZE + 1;
+
+    // counting sort of the ports by cell
+    std::vector<int> cell_idxs(n_ports);
+    CELL_STARTS.assign(N_COLS * N_ROWS + 1, 0);
+    for (int i = 0; i < n_ports; ++i) {
+        Vector2 position = positions[i];
+        cell_idxs[i] = get_row(position.y) * N_COLS + get_col(position.x);
+        CELL_STARTS[cell_idxs[i] + 1] += 1;
+    }
+    for (int c = 0; c < N_COLS * N_ROWS; ++c) {
+        CELL_STARTS[c + 1] += CELL_STARTS[c];
+    }
+
+    PORT_IDXS.resize(n_ports);
+    POSITIONS.resize(n_ports);
+    std::vector<int> cursors(CELL_STARTS.begin(), CELL_STARTS.end() - 1);
+    for (int i = 0; i < n_ports; ++i) {
+        int k = cursors[cell_idxs[i]]++;
+        PORT_IDXS[k] = i;
+        POSITIONS[k] = positions[i];
+    }
+}
+
+float get_max_port_radius() {
+    return MAX_PORT_RADIUS;
+}
+
+// Calls fn(k) for every grid entry k within the radius of the position.
+template <typename F>
+void for_each_in_radius(Vector2 position, float radius, F fn) {
+    if (N_COLS == 0) return;
+
+    int col0 = get_col(position.x - radius);
+    int col1 = get_col(position.x + radius);
+    int row0 = get_row(position.y - radius);
+    int row1 = get_row(position.y + radius);
+    float radius_sqr = radius * radius;
+
+    for (int row = row0; row <= row1; ++row) {
+        for (int col = col0; col <= col1; ++col) {
+            int c = row * N_COLS + col;
+            for (int k = CELL_STARTS[c]; k < CELL_STARTS[c + 1]; ++k) {
+                if (Vector2DistanceSqr(position, POSITIONS[k]) <= radius_sqr) fn(k);
+            }
+        }
+    }
+}
+
+void find_in_radius(Vector2 position, float radius, std::vector<int> &port_idxs) {
+    for_each_in_radius(position, radius, [&](int k) {
+        port_idxs.push_back(PORT_IDXS[k]);
+    });
+}
+
+int find_nearest(Vector2 position, int k, int *port_idxs) {
+    k = std::min(k, (int)PORT_IDXS.size());
+    if (k <= 0) return 0;
+
+    // best k candidates as (squared distance, port idx), sorted
+    static thread_local std::vector<std::pair<float, int>> best;
+    best.clear();
+    best.reserve(k + 1);
+
+    // visit rings of cells around the position's cell until no cell of the
+    // next ring can be closer than the k-th best candidate
+    int col = get_col(position.x);
+    int row = get_row(position.y);
+    int max_ring = std::max(N_COLS, N_ROWS);
+    for (int ring = 0; ring < max_ring; ++ring) {
+        if ((int)best.size() == k) {
+            // the ring's cells are at least (ring - 1) cells away
+            float min_dist = (ring - 1) * CELL_SIZE;
+            if (min_dist > 0.0 && min_dist * min_dist > best.back().first) break;
+        }
+
+        for (int r = row - ring; r <= row + ring; ++r) {
+            if (r < 0 || r >= N_ROWS) continue;
+
+            bool is_edge_row = r == row - ring || r == row + ring;
+            int step = is_edge_row ? 1 : 2 * ring;
+            for (int c = col - ring; c <= col + ring; c += std::max(step, 1)) {
+                if (c < 0 || c >= N_COLS) continue;
+
+                int cell = r * N_COLS + c;
+                for (int i = CELL_STARTS[cell]; i < CELL_STARTS[cell + 1]; ++i) {
+                    float dist_sqr = Vector2DistanceSqr(position, POSITIONS[i]);
+                    if ((int)best.size() == k && dist_sqr >= best.back().first) continue;
+
+                    auto candidate = std::make_pair(dist_sqr, PORT_IDXS[i]);
+                    auto it = std::upper_bound(best.begin(), best.end(), candidate);
+                    best.insert(it, candidate);
+                    if ((int)best.size() > k) best.pop_back();
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < (int)best.size(); ++i) port_idxs[i] = best[i].second;
+    return best.size();
+}
+
+}  // namespace port_index
+}  // namespace st
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "raylib/raylib.h"
+#include <vector>
+
+namespace st {
+namespace port_index {
+
+// Buckets the ports that exist at the moment (call it after the ports are
+// spawned) into a uniform grid. The index is static: ports don't move and
+// are never added later.
+void load();
+
+// Largest port radius: a position can only be inside a port within this
+// distance.
+float get_max_port_radius();
+
+// Indices (in the ports group) of the ports within the radius of the
+// position, in no particular order. The result is appended to port_idxs.
+void find_in_radius(Vector2 position, float radius, std::vector<int> &port_idxs);
+
+// Writes the indices of the k ports nearest to the position into port_idxs
+// (room for k), nearest first. Returns how many were written, fewer than k if
+// there are less ports.
+int find_nearest(Vector2 position, int k, int *port_idxs);
+
+}  // namespace port_index
+}  // namespace st
@@ -0,0 +1,137 @@
+#include "port_zones.hpp"
+
+#include "components.hpp"
+#include "entt/entity/fwd.hpp"
+#include "entt/entt.hpp"
+#include "port_index.hpp"
+#include "profiler.hpp"
+#include "raylib/raylib.h"
+#include "raylib/raymath.h"
+#include "registry.hpp"
+#include "terrain.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+namespace st {
+namespace port_zones {
+
+static const float CELL_SIZE = 4.0;
+
+// Cell c overlaps the zones of ports PORT_IDXS[CELL_STARTS[c]] up to
+// PORT_IDXS[CELL_STARTS[c + 1]]. Most cells overlap none.
+static int N_CELLS_PER_SIDE = 0;
+static std::vector<int> CELL_STARTS;
+static std::vector<int> PORT_IDXS;
+
+// port positions and radii, by port idx
+static std::vector<Vector2> POSITIONS;
+static std::vector<float> RADII;
+
+static std::vector<std::function<void(const Event &)>> LISTENERS;
+static std::vector<Event> EVENTS;
+
+void load() {
+    int n_ports = registry::get_ports_group().size();
+    POSITIONS.resize(n_ports);
+    RADII.resize(n_ports);
+    for (int i = 0; i < n_ports; ++i) {
+        auto entity = registry::get_port_entity(i);
+        POSITIONS[i] = registry::registry.get<components::Transform>(entity).position;
+        RADII[i] = registry::registry.get<components::Port>(entity).radius;
+    }
+
+    N_CELLS_PER_SIDE = std::ceil(terrain::get_world_size() / CELL_SIZE);
+    int n_cells = N_CELLS_PER_SIDE * N_CELLS_PER_SIDE;
+    CELL_STARTS.assign(n_cells + 1, 0);
+    PORT_IDXS.clear();
+
+    // a zone overlaps the cell if the port is within its radius of the cell
+    // (approximated by the cell's circumscribed circle)
+    float cell_radius = 0.5 * M_SQRT2 * CELL_SIZE;
+    float query_radius = cell_radius + port_index::get_max_port_radius();
+    std::vector<int> port_idxs;
+    for (int c = 0; c < n_cells; ++c) {
+        Vector2 center = {
+            ((c % N_CELLS_PER_SIDE) + 0.5f) * CELL_SIZE,
+            ((c / N_CELLS_PER_SIDE) + 0.5f) * CELL_SIZE,
+        };
+
+        port_idxs.clear();
+        port_index::find_in_radius(center, query_radius, port_idxs);
+        for (int port_idx : port_idxs) {
+            float dist = Vector2Distance(center, POSITIONS[port_idx]);
+            if (dist <= cell_radius + RADII[port_idx]) PORT_IDXS.push_back(port_idx);
+        }
+        CELL_STARTS[c + 1] = PORT_IDXS.size();
+    }
+}
+
+void subscribe(std::function<void(const Event &)> fn) {
+    LISTENERS.push_back(fn);
+}
+
+int get_cell(Vector2 position) {
+    int col = std::clamp((int)(position.x / CELL_SIZE), 0, N_CELLS_PER_SIDE - 1);
+    int row = std::clamp((int)(position.y / CELL_SIZE), 0, N_CELLS_PER_SIDE - 1);
+    return row * N_CELLS_PER_SIDE + col;
+}
+
+// Port idx of the zone containing the position, -1 if none.
+int find_zone(Vector2 position) {
+    int c = get_cell(position);
+    for (int k = CELL_STARTS[c]; k < CELL_STARTS[c + 1]; ++k) {
+        int port_idx = PORT_IDXS[k];
+        if (Vector2Distance(position, POSITIONS[port_idx]) <= RADII[port_idx]) {
+            return port_idx;
+        }
+    }
+
+    return -1;
+}
+
+void update() {
+    if (N_CELLS_PER_SIDE == 0) return;
+
+    auto group = registry::get_ships_group();
+    auto entities = group.storage<components::Transform>()->data();
+    auto transforms = group.storage<components::Transform>()->rbegin();
+    auto &presences = registry::registry.storage<Presence>();
+
+    EVENTS.clear();
+    for (size_t i = 0; i < group.size(); ++i) {
+        entt::entity entity = entities[i];
+        int c = get_cell(transforms[i].position);
+        bool is_zone_cell = CELL_STARTS[c] != CELL_STARTS[c + 1];
+        if (!is_zone_cell && !presences.contains(entity)) continue;
+
+        int port_idx = find_zone(transforms[i].position);
+        int prev_port_idx = -1;
+        if (presences.contains(entity)) prev_port_idx = presences.get(entity).port_idx;
+        if (port_idx == prev_port_idx) continue;
+
+        if (prev_port_idx != -1) {
+            EVENTS.push_back({EventType::EXIT, entity, prev_port_idx});
+        }
+        if (port_idx != -1) {
+            EVENTS.push_back({EventType::ENTER, entity, port_idx});
+        }
+    }
+
+    // listeners run after the scan, so they may change the registry freely
+    for (auto &event : EVENTS) {
+        if (event.type == EventType::EXIT) {
+            presences.remove(event.ship_entity);
+        } else {
+            presences.emplace(event.ship_entity, event.port_idx);
+        }
+
+        for (auto &fn : LISTENERS) fn(event);
+    }
+
+    profiler::add_counter("port_zones.n_events", EVENTS.size());
+}
+
+}  // namespace port_zones
+}  // namespace st
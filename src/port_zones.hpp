@@ -0,0 +1,42 @@
+#pragma once
+
+#include "entt/entity/fwd.hpp"
+#include "entt/entt.hpp"
+#include <functional>
+
+namespace st {
+namespace port_zones {
+
+// Attached to a ship while it's inside a port's radius.
+class Presence {
+public:
+    int port_idx;
+};
+
+enum class EventType {
+    ENTER,
+    EXIT,
+};
+
+class Event {
+public:
+    EventType type;
+    entt::entity ship_entity;
+    int port_idx;
+};
+
+// Builds the trigger grid over the world: every cell lists the ports whose
+// radius overlaps it. Call it after port_index::load.
+void load();
+
+// Listeners are called on the simulation thread, from update, one event
+// at a time. Add them before the simulation starts.
+void subscribe(std::function<void(const Event &)> fn);
+
+// Finds the ships which crossed a port's radius since the last update,
+// attaches or removes their Presence and fires the events. Ships outside
+// the cells touched by a port zone cost one cell lookup.
+void update();
+
+}  // namespace port_zones
+}  // namespace st
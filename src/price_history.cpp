@@ -0,0 +1,143 @@
+#include "price_history.hpp"
+
+#include "cargo.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace st {
+namespace price_history {
+
+// Ring buffer of the latest N_SAMPLES samples, and a ring of N_BUCKETS
+// min/max/sum buckets of BUCKET_SIZE samples each for the longer history.
+static const int N_SAMPLES = 64;
+static const int BUCKET_SIZE = 16;
+static const int N_BUCKETS = 32;
+
+// Samples are price coefficients quantized to one byte on a log2 scale,
+// ~1.6% per step.
+static const float MIN_LOG2_COEFF = -3.0;
+static const float MAX_LOG2_COEFF = 3.0;
+static const float QUANT_SCALE = 255.0 / (MAX_LOG2_COEFF - MIN_LOG2_COEFF);
+
+// All arrays are time-major: row t holds the t-th sample (or bucket) of all
+// N_SERIES series, so recording a sample is one contiguous pass. Series of
+// a port and product is product_idx * N_PORTS + port_idx, the economy
+// layout. Bucket sums are of the dequantized coefficients, so the average is
+// the arithmetic one. That's 256 bytes per series.
+static int N_PORTS = 0;
+static int N_SERIES = 0;
+static uint64_t N_RECORDED = 0;
+static std::vector<uint8_t> SAMPLES;
+static std::vector<uint8_t> BUCKET_MINS;
+static std::vector<uint8_t> BUCKET_MAXS;
+static std::vector<float> BUCKET_SUMS;
+static std::array<float, 256> DEQUANTIZED;
+
+uint8_t quantize(float coeff) {
+    float q = (std::log2(coeff) - MIN_LOG2_COEFF) * QUANT_SCALE;
+    return std::clamp(q, 0.0f, 255.0f) + 0.5f;
+}
+
+float dequantize(float q) {
+    return std::exp2(q / QUANT_SCALE + MIN_LOG2_COEFF);
+}
+
+int get_series_idx(int port_idx, cargo::ProductID product_id) {
+    return (int)product_id * N_PORTS + port_idx;
+}
+
+void load(int n_ports) {
+    N_PORTS = n_ports;
+    N_SERIES = cargo::N_PRODUCTS * n_ports;
+    N_RECORDED = 0;
+    SAMPLES.assign(N_SAMPLES * N_SERIES, 0);
+    BUCKET_MINS.assign(N_BUCKETS * N_SERIES, 0);
+    BUCKET_MAXS.assign(N_BUCKETS * N_SERIES, 0);
+    BUCKET_SUMS.assign(N_BUCKETS * N_SERIES, 0.0);
+    for (int q = 0; q < 256; ++q) DEQUANTIZED[q] = dequantize(q);
+}
+
+void record(const float *price_coeffs) {
+    uint8_t *samples = &SAMPLES[(N_RECORDED % N_SAMPLES) * N_SERIES];
+    for (int i = 0; i < N_SERIES; ++i) {
+        samples[i] = quantize(price_coeffs[i]);
+    }
+
+    // the bucket is updated incrementally, sample by sample
+    int bucket_offset = (N_RECORDED / BUCKET_SIZE) % N_BUCKETS * N_SERIES;
+    uint8_t *mins = &BUCKET_MINS[bucket_offset];
+    uint8_t *maxs = &BUCKET_MAXS[bucket_offset];
+    float *sums = &BUCKET_SUMS[bucket_offset];
+    if (N_RECORDED % BUCKET_SIZE == 0) {
+        for (int i = 0; i < N_SERIES; ++i) {
+            mins[i] = samples[i];
+            maxs[i] = samples[i];
+            sums[i] = DEQUANTIZED[samples[i]];
+        }
+    } else {
+        for (int i = 0; i < N_SERIES; ++i) {
+            mins[i] = std::min(mins[i], samples[i]);
+            maxs[i] = std::max(maxs[i], samples[i]);
+            sums[i] += DEQUANTIZED[samples[i]];
+        }
+    }
+
+    N_RECORDED += 1;
+}
+
+std::vector<float> get_samples(int port_idx, cargo::ProductID product_id) {
+    int series_idx = get_series_idx(port_idx, product_id);
+    int n = std::min<uint64_t>(N_RECORDED, N_SAMPLES);
+
+    std::vector<float> samples(n);
+    for (int i = 0; i < n; ++i) {
+        uint64_t t = (N_RECORDED - n + i) % N_SAMPLES;
+        samples[i] = dequantize(SAMPLES[t * N_SERIES + series_idx]);
+    }
+
+    return samples;
+}
+
+std::vector<Bucket> get_buckets(int port_idx, cargo::ProductID product_id) {
+    int series_idx = get_series_idx(port_idx, product_id);
+    uint64_t n_started = (N_RECORDED + BUCKET_SIZE - 1) / BUCKET_SIZE;
+    int n = std::min<uint64_t>(n_started, N_BUCKETS);
+
+    std::vector<Bucket> buckets(n);
+    for (int i = 0; i < n; ++i) {
+        uint64_t bucket_idx = n_started - n + i;
+        int offset = bucket_idx % N_BUCKETS * N_SERIES + series_idx;
+
+        int n_bucket_samples = BUCKET_SIZE;
+        if (bucket_idx == n_started - 1 && N_RECORDED % BUCKET_SIZE != 0) {
+            n_bucket_samples = N_RECORDED % BUCKET_SIZE;
+        }
+
+        buckets[i] = {
+            .min = dequantize(BUCKET_MINS[offset]),
+            .max = dequantize(BUCKET_MAXS[offset]),
+            .avg = BUCKET_SUMS[offset] / n_bucket_samples,
+        };
+    }
+
+    return buckets;
+}
+
+float get_trend(int port_idx, cargo::ProductID product_id) {
+    uint64_t n_complete = N_RECORDED / BUCKET_SIZE;
+    if (n_complete == 0) return 1.0;
+
+    int series_idx = get_series_idx(port_idx, product_id);
+    uint64_t t = (N_RECORDED - 1) % N_SAMPLES;
+    float sample = DEQUANTIZED[SAMPLES[t * N_SERIES + series_idx]];
+    int offset = (n_complete - 1) % N_BUCKETS * N_SERIES + series_idx;
+    float avg = BUCKET_SUMS[offset] / BUCKET_SIZE;
+
+    return sample / avg;
+}
+
+}  // namespace price_history
+}  // namespace st
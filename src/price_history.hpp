@@ -0,0 +1,36 @@
+#pragma once
+
+#include "cargo.hpp"
+#include <vector>
+
+namespace st {
+namespace price_history {
+
+// Aggregate of BUCKET_SIZE consecutive samples, avg is their arithmetic mean.
+class Bucket {
+public:
+    float min;
+    float max;
+    float avg;
+};
+
+// Allocates one series per port and product, with no samples yet.
+void load(int n_ports);
+
+// Appends one sample to every series. price_coeffs are the mid price
+// coefficients in the economy layout: product-major, one row of n_ports
+// values per product.
+void record(const float *price_coeffs);
+
+// The latest samples (oldest first) and the downsampled history (oldest
+// bucket first, the last one may be still incomplete) of one series, as
+// price coefficients.
+std::vector<float> get_samples(int port_idx, cargo::ProductID product_id);
+std::vector<Bucket> get_buckets(int port_idx, cargo::ProductID product_id);
+
+// The latest sample relative to the average of the latest complete bucket:
+// above 1 while the price is rising. 1 until a bucket is complete.
+float get_trend(int port_idx, cargo::ProductID product_id);
+
+}  // namespace price_history
+}  // namespace st
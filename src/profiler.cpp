@@ -1,7 +1,12 @@
 #include "profiler.hpp"
 
 #include "raylib/raylib.h"
+#include "ui.hpp"
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
+#include <map>
+#include <mutex>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -10,18 +15,25 @@
 namespace st {
 namespace profiler {
 
+static const auto START_TIME = std::chrono::steady_clock::now();
+
+double get_time() {
+    auto time = std::chrono::steady_clock::now() - START_TIME;
+    return std::chrono::duration<double>(time).count();
+}
+
 class Stage {
 public:
     std::string name;
     std::string path;
-    float start_time;
+    double start_time;
 
     Stage() = default;
 
     Stage(std::string name, std::string path)
         : name(name)
         , path(path)
-        , start_time(GetTime()) {}
+        , start_time(get_time()) {}
 
     std::string get_path() {
         if (this->path.length() == 0) {
@@ -35,7 +47,7 @@ public:
 class StageStats {
 public:
     std::string path;
-    float total_time = 0.0;
+    double total_time = 0.0;
     int total_n_calls = 0;
 
     StageStats() = default;
@@ -50,13 +62,16 @@ public:
             throw std::runtime_error(msg);
         }
 
-        this->total_time += GetTime() - stage.start_time;
+        this->total_time += get_time() - stage.start_time;
         this->total_n_calls += 1;
     }
 };
 
-static std::vector<Stage> STACK;
+// every thread has its own stage stack, the stats are shared
+static thread_local std::vector<Stage> STACK;
+static std::mutex MUTEX;
 static std::unordered_map<std::string, StageStats> STATS;
+static std::map<std::string, double> COUNTERS;
 
 void push(const std::string name) {
     if (STACK.size() != 0 && STACK.back().name == name) {
@@ -83,24 +98,64 @@ void pop() {
     auto stage = STACK.back();
     auto path = stage.get_path();
 
-    if (STATS.count(path) == 0) {
-        STATS[path] = StageStats(path);
-    }
+    {
+        std::lock_guard<std::mutex> lock(MUTEX);
+        if (STATS.count(path) == 0) {
+            STATS[path] = StageStats(path);
+        }
 
-    auto stats = &STATS[path];
-    stats->update(stage);
+        auto stats = &STATS[path];
+        stats->update(stage);
+    }
 
     STACK.pop_back();
 }
 
+void set_counter(const std::string name, double value) {
+    std::lock_guard<std::mutex> lock(MUTEX);
+    COUNTERS[name] = value;
+}
+
+void add_counter(const std::string name, double value) {
+    std::lock_guard<std::mutex> lock(MUTEX);
+    COUNTERS[name] += value;
+}
+
 void draw() {
-    // TODO: make proper ui
+    static const int font_size = 20;
+    static const int x = 10;
+
+    std::lock_guard<std::mutex> lock(MUTEX);
+
+    char text[256];
+    int y = 10;
+    for (auto &[name, stats] : STATS) {
+        float avg_ms = 1000.0 * stats.total_time / std::max(stats.total_n_calls, 1);
+        snprintf(text, sizeof(text), "%s: %.3f ms", name.c_str(), avg_ms);
+        DrawText(text, x, y, font_size, ui::color::TEXT_LIGHT);
+        y += font_size;
+    }
+
+    for (auto &[name, value] : COUNTERS) {
+        snprintf(text, sizeof(text), "%s: %g", name.c_str(), value);
+        DrawText(text, x, y, font_size, ui::color::TEXT_LIGHT);
+        y += font_size;
+    }
+}
+
+void print() {
+    std::lock_guard<std::mutex> lock(MUTEX);
+
     for (auto &[name, stats] : STATS) {
         printf("%s", name.c_str());
         printf("\n");
         printf("    n_calls : %d\n", stats.total_n_calls);
         printf("    time    : %f\n", stats.total_time);
     }
+
+    for (auto &[name, value] : COUNTERS) {
+        printf("%s : %g\n", name.c_str(), value);
+    }
 }
 
 }  // namespace profiler
@@ -20,7 +20,11 @@ auto profile_function(const std::string name, F &&fn, Args &&...args)
     return result;
 }
 
+void set_counter(const std::string name, double value);
+void add_counter(const std::string name, double value);
+
 void draw();
+void print();
 
 }  // namespace profiler
 }  // namespace st
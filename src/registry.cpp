@@ -8,5 +8,10 @@ namespace registry {
 
 entt::registry registry;
 
+void load() {
+    get_ships_group();
+    get_ports_group();
 }
+
+}  // namespace registry
 }  // namespace st
@@ -1,12 +1,40 @@
 #pragma once
 
+#include "components.hpp"
+#include "dynamic_body.hpp"
 #include "entt/entity/fwd.hpp"
 #include "entt/entt.hpp"
+#include "ship.hpp"
 
 namespace st {
 namespace registry {
 
 extern entt::registry registry;
 
+void load();
+
+// Owning groups for the hot component combinations, created by load before
+// any entity exists. entt doesn't allow two owning groups to share a
+// component, so ships own all of their physics components in one group.
+// The first group.size() elements of every owned storage are aligned, so
+// storage->rbegin()[i] can be indexed directly (e.g. in parallel_for).
+inline auto get_ships_group() {
+    return registry.group<components::Transform, dynamic_body::DynamicBody, ship::Ship>();
+}
+
+inline auto get_ports_group() {
+    return registry.group<components::Port>(entt::get<components::Transform>);
+}
+
+// Dense index of the port within the ports group, 0..n_ports-1. Stable as long
+// as no port is destroyed.
+inline int get_port_idx(entt::entity port_entity) {
+    return get_ports_group().storage<components::Port>()->index(port_entity);
+}
+
+inline entt::entity get_port_entity(int port_idx) {
+    return get_ports_group().storage<components::Port>()->data()[port_idx];
+}
+
 }  // namespace registry
 }  // namespace st
@@ -0,0 +1,87 @@
+#include "render_state.hpp"
+
+#include "components.hpp"
+#include "raylib/raymath.h"
+#include "registry.hpp"
+#include "ship.hpp"
+#include <mutex>
+
+namespace st {
+namespace render_state {
+
+static std::mutex MUTEX;
+
+// Buffer pool indexed instead of copied: PUBLISHED holds the previous and
+// the newest published states, ACQUIRED the ones the render thread draws.
+// Both pairs use at most 4 buffers, so the simulation always finds a free
+// one to capture into.
+static const int N_STATES = 5;
+static RenderState STATES[N_STATES];
+static int PUBLISHED[2] = {0, 1};
+static int ACQUIRED[2] = {0, 1};
+
+void capture(RenderState *state, double time) {
+    state->time = time;
+
+    state->ships.clear();
+    auto ships = registry::get_ships_group();
+    for (auto [entity, transform, body, ship] : ships.each()) {
+        state->ships.push_back({entity, transform.position, transform.rotation});
+    }
+
+    state->ports.clear();
+    auto ports = registry::get_ports_group();
+    for (auto [entity, port, transform] : ports.each()) {
+        state->ports.push_back({transform.position, port.radius});
+    }
+
+    auto players = registry::registry.view<components::Player>();
+    if (!players.empty()) {
+        auto &transform = registry::registry.get<components::Transform>(players.front());
+        state->player_position = transform.position;
+    }
+}
+
+int get_free_state_idx() {
+    std::lock_guard<std::mutex> lock(MUTEX);
+    for (int idx = 0; idx < N_STATES; ++idx) {
+        bool is_published = idx == PUBLISHED[0] || idx == PUBLISHED[1];
+        bool is_acquired = idx == ACQUIRED[0] || idx == ACQUIRED[1];
+        if (!is_published && !is_acquired) return idx;
+    }
+
+    return -1;
+}
+
+void publish(double time) {
+    // nobody else touches an unpublished state, it's captured without the lock
+    int idx = get_free_state_idx();
+    capture(&STATES[idx], time);
+
+    std::lock_guard<std::mutex> lock(MUTEX);
+    PUBLISHED[0] = PUBLISHED[1];
+    PUBLISHED[1] = idx;
+}
+
+void acquire(const RenderState **prev, const RenderState **curr) {
+    std::lock_guard<std::mutex> lock(MUTEX);
+    ACQUIRED[0] = PUBLISHED[0];
+    ACQUIRED[1] = PUBLISHED[1];
+    *prev = &STATES[ACQUIRED[0]];
+    *curr = &STATES[ACQUIRED[1]];
+}
+
+ShipState interpolate(ShipState prev, ShipState curr, float alpha) {
+    if (prev.entity != curr.entity) return curr;
+
+    ShipState state = curr;
+    state.position = Vector2Lerp(prev.position, curr.position, alpha);
+    // rotations aren't normalized (the physics accumulates them, LOD tier
+    // switches reset them to [-PI, PI]), so turn the short way
+    float delta = Wrap(curr.rotation - prev.rotation, -PI, PI);
+    state.rotation = prev.rotation + delta * alpha;
+    return state;
+}
+
+}  // namespace render_state
+}  // namespace st
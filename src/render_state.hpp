@@ -0,0 +1,45 @@
+#pragma once
+
+#include "entt/entity/fwd.hpp"
+#include "entt/entt.hpp"
+#include "raylib/raylib.h"
+#include <vector>
+
+namespace st {
+namespace render_state {
+
+class ShipState {
+public:
+    entt::entity entity;
+    Vector2 position;
+    float rotation;
+};
+
+class PortState {
+public:
+    Vector2 position;
+    float radius;
+};
+
+class RenderState {
+public:
+    double time = 0.0;
+    std::vector<ShipState> ships;
+    std::vector<PortState> ports;
+    Vector2 player_position = {0.0, 0.0};
+};
+
+// Called by the simulation thread after each tick (with the world locked).
+// Captures the registry into a free buffer of a small pool (one the render
+// thread doesn't hold) and publishes it as the newest state, the previous
+// newest becomes the older of the two published ones.
+void publish(double time);
+
+// Called by the render thread. Points to the two latest published states,
+// they stay valid until the next acquire.
+void acquire(const RenderState **prev, const RenderState **curr);
+
+ShipState interpolate(ShipState prev, ShipState curr, float alpha);
+
+}  // namespace render_state
+}  // namespace st
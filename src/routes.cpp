@@ -0,0 +1,265 @@
+#include "routes.hpp"
+
+#include "cargo.hpp"
+#include "components.hpp"
+#include "jobs.hpp"
+#include "port_index.hpp"
+#include "raylib/raylib.h"
+#include "raylib/raymath.h"
+#include "registry.hpp"
+#include "terrain.hpp"
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+namespace st {
+namespace routes {
+
+static const int N_BEST_ROUTES = 8;
+// Paths are only searched to this many nearest ports (and from them): far
+// routes rarely pay off per distance and there are O(N^2) of them.
+static const int N_NEIGHBOUR_PORTS = 12;
+
+// Port i is the i-th port of the ports group. DISTANCES and PATHS are
+// [from_port][to_port], PROFITS is [from_port][to_port][product], prices are
+// [port][product] as of the last update.
+static int N_PORTS = 0;
+static std::vector<float> DISTANCES;
+static std::vector<std::vector<Vector2>> PATHS;
+static std::vector<float> PROFITS;
+static std::vector<int> BUY_PRICES;
+static std::vector<int> SELL_PRICES;
+static std::vector<uint8_t> IS_PORT_CHANGED;
+static std::vector<int> CHANGED_PORT_IDXS;
+static std::vector<std::vector<Route>> BEST_ROUTES;
+
+float get_path_length(Vector2 start, const std::vector<Vector2> &path) {
+    float length = 0.0;
+    for (Vector2 point : path) {
+        length += Vector2Distance(start, point);
+        start = point;
+    }
+
+    return length;
+}
+
+// Refreshes the cached prices, returns true if any port's prices changed.
+bool update_prices() {
+    auto group = registry::get_ports_group();
+    auto ports = group.storage<components::Port>()->rbegin();
+
+    CHANGED_PORT_IDXS.clear();
+    for (int i = 0; i < N_PORTS; ++i) {
+        auto &prices = ports[i].prices;
+        bool is_changed = false;
+
+        for (int p = 0; p < cargo::N_PRODUCTS; ++p) {
+            int idx = i * cargo::N_PRODUCTS + p;
+            int buy_price = prices.get_buy_price((cargo::ProductID)p);
+            int sell_price = prices.get_sell_price((cargo::ProductID)p);
+            is_changed |= BUY_PRICES[idx] != buy_price || SELL_PRICES[idx] != sell_price;
+            BUY_PRICES[idx] = buy_price;
+            SELL_PRICES[idx] = sell_price;
+        }
+
+        IS_PORT_CHANGED[i] = is_changed;
+        if (is_changed) CHANGED_PORT_IDXS.push_back(i);
+    }
+
+    return !CHANGED_PORT_IDXS.empty();
+}
+
+void update_profits(int from_port_idx, int to_port_idx) {
+    int pair_idx = from_port_idx * N_PORTS + to_port_idx;
+    float distance = DISTANCES[pair_idx];
+    float *profits = &PROFITS[pair_idx * cargo::N_PRODUCTS];
+
+    // the ship buys at the source port's sell price and sells at the
+    // destination port's buy price
+    const int *ship_buy_prices = &SELL_PRICES[from_port_idx * cargo::N_PRODUCTS];
+    const int *ship_sell_prices = &BUY_PRICES[to_port_idx * cargo::N_PRODUCTS];
+
+    for (int p = 0; p < cargo::N_PRODUCTS; ++p) {
+        if (distance == FLT_MAX || from_port_idx == to_port_idx) {
+            profits[p] = 0.0;
+            continue;
+        }
+
+        float unit_weight = cargo::get_product((cargo::ProductID)p).unit_weight;
+        int unit_profit = ship_sell_prices[p] - ship_buy_prices[p];
+        profits[p] = unit_profit / unit_weight / distance;
+    }
+}
+
+// Merges the routes to the port into the best routes of the row.
+void insert_best_routes(int from_port_idx, int to_port_idx) {
+    auto &routes = BEST_ROUTES[from_port_idx];
+    int offset = (from_port_idx * N_PORTS + to_port_idx) * cargo::N_PRODUCTS;
+
+    for (int p = 0; p < cargo::N_PRODUCTS; ++p) {
+        float profit = PROFITS[offset + p];
+        if (profit <= 0.0) continue;
+        bool is_full = routes.size() == N_BEST_ROUTES;
+        if (is_full && profit <= routes.back().profit) continue;
+
+        Route route = {
+            .from_port_idx = from_port_idx,
+            .to_port_idx = to_port_idx,
+            .product_id = (cargo::ProductID)p,
+            .profit = profit,
+        };
+        auto it = std::upper_bound(
+            routes.begin(),
+            routes.end(),
+            route,
+            [](const Route &a, const Route &b) { return a.profit > b.profit; }
+        );
+        routes.insert(it, route);
+        if (routes.size() > N_BEST_ROUTES) routes.pop_back();
+    }
+}
+
+void update_best_routes(int from_port_idx) {
+    BEST_ROUTES[from_port_idx].clear();
+    for (int to_port_idx = 0; to_port_idx < N_PORTS; ++to_port_idx) {
+        insert_best_routes(from_port_idx, to_port_idx);
+    }
+}
+
+// The row is kept unless one of its best routes went to a changed port (its
+// profit may have dropped, so a route outside the list could take its
+// place). Routes to unchanged ports stay where they were, so the changed
+// ports only need to be merged in.
+void update_best_routes_incrementally(int from_port_idx) {
+    bool is_rescan_needed = IS_PORT_CHANGED[from_port_idx];
+    for (auto &route : BEST_ROUTES[from_port_idx]) {
+        is_rescan_needed |= IS_PORT_CHANGED[route.to_port_idx];
+    }
+
+    if (is_rescan_needed) {
+        update_best_routes(from_port_idx);
+        return;
+    }
+
+    for (int to_port_idx : CHANGED_PORT_IDXS) {
+        insert_best_routes(from_port_idx, to_port_idx);
+    }
+}
+
+void allocate() {
+    N_PORTS = registry::get_ports_group().size();
+    DISTANCES.assign(N_PORTS * N_PORTS, FLT_MAX);
+    PATHS.assign(N_PORTS * N_PORTS, {});
+    PROFITS.assign(N_PORTS * N_PORTS * cargo::N_PRODUCTS, 0.0);
+    BUY_PRICES.assign(N_PORTS * cargo::N_PRODUCTS, -1);
+    SELL_PRICES.assign(N_PORTS * cargo::N_PRODUCTS, -1);
+    IS_PORT_CHANGED.assign(N_PORTS, 0);
+    CHANGED_PORT_IDXS.reserve(N_PORTS);
+    BEST_ROUTES.assign(N_PORTS, {});
+    for (auto &routes : BEST_ROUTES) routes.reserve(N_BEST_ROUTES + 1);
+}
+
+void load() {
+    auto ports = registry::get_ports_group().storage<components::Port>()->rbegin();
+    allocate();
+
+    for (int i = 0; i < N_PORTS; ++i) DISTANCES[i * N_PORTS + i] = 0.0;
+
+    // sea distances are symmetric, so only one path per pair of ports, i < j
+    std::vector<uint8_t> is_pair(N_PORTS * N_PORTS, 0);
+    std::array<int, N_NEIGHBOUR_PORTS + 1> neighbour_idxs;
+    for (int i = 0; i < N_PORTS; ++i) {
+        // the port itself is the nearest one
+        int n_neighbours = port_index::find_nearest(
+            ports[i].dock_position, neighbour_idxs.size(), neighbour_idxs.data()
+        );
+        for (int k = 0; k < n_neighbours; ++k) {
+            int j = neighbour_idxs[k];
+            if (j != i) is_pair[std::min(i, j) * N_PORTS + std::max(i, j)] = 1;
+        }
+    }
+
+    std::vector<int> pair_idxs;
+    std::vector<Vector2> starts;
+    std::vector<Vector2> ends;
+    for (int i = 0; i < N_PORTS; ++i) {
+        for (int j = i + 1; j < N_PORTS; ++j) {
+            if (!is_pair[i * N_PORTS + j]) continue;
+            pair_idxs.push_back(i * N_PORTS + j);
+            starts.push_back(ports[i].dock_position);
+            ends.push_back(ports[j].dock_position);
+        }
+    }
+
+    auto paths = terrain::get_paths(starts, ends);
+
+    for (size_t k = 0; k < pair_idxs.size(); ++k) {
+        int i = pair_idxs[k] / N_PORTS;
+        int j = pair_idxs[k] % N_PORTS;
+        auto &path = paths[k];
+        if (path.empty()) continue;
+
+        float distance = get_path_length(starts[k], path);
+        DISTANCES[i * N_PORTS + j] = distance;
+        DISTANCES[j * N_PORTS + i] = distance;
+
+        // the way back: same points in reverse, ending at the start dock
+        std::vector<Vector2> back_path(path.rbegin() + 1, path.rend());
+        back_path.push_back(starts[k]);
+        PATHS[i * N_PORTS + j] = std::move(path);
+        PATHS[j * N_PORTS + i] = std::move(back_path);
+    }
+
+    update();
+}
+
+void load(
+    const float *distances, const uint32_t *path_offsets, const Vector2 *path_points
+) {
+    allocate();
+
+    std::copy_n(distances, DISTANCES.size(), DISTANCES.begin());
+    for (size_t i = 0; i < PATHS.size(); ++i) {
+        PATHS[i].assign(path_points + path_offsets[i], path_points + path_offsets[i + 1]);
+    }
+
+    update();
+}
+
+void update() {
+    if (!update_prices()) return;
+
+    jobs::parallel_for(0, N_PORTS, 1, [](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            if (IS_PORT_CHANGED[i]) {
+                for (int j = 0; j < N_PORTS; ++j) update_profits(i, j);
+            } else {
+                for (int j : CHANGED_PORT_IDXS) update_profits(i, j);
+            }
+
+            update_best_routes_incrementally(i);
+        }
+    });
+}
+
+float get_distance(int from_port_idx, int to_port_idx) {
+    return DISTANCES[from_port_idx * N_PORTS + to_port_idx];
+}
+
+const std::vector<Vector2> &get_path(int from_port_idx, int to_port_idx) {
+    return PATHS[from_port_idx * N_PORTS + to_port_idx];
+}
+
+float get_profit(int from_port_idx, int to_port_idx, cargo::ProductID product_id) {
+    int idx = (from_port_idx * N_PORTS + to_port_idx) * cargo::N_PRODUCTS;
+    return PROFITS[idx + (int)product_id];
+}
+
+const std::vector<Route> &get_best_routes(int from_port_idx) {
+    return BEST_ROUTES[from_port_idx];
+}
+
+}  // namespace routes
+}  // namespace st
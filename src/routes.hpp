@@ -0,0 +1,50 @@
+#pragma once
+
+#include "cargo.hpp"
+#include "raylib/raylib.h"
+#include <cstdint>
+#include <vector>
+
+namespace st {
+namespace routes {
+
+// Carrying the product from one port to another. profit is the money made
+// per unit of cargo weight per unit of sea distance.
+class Route {
+public:
+    int from_port_idx;
+    int to_port_idx;
+    cargo::ProductID product_id;
+    float profit;
+};
+
+// Finds the sea paths and distances between the docks of the ports that
+// exist at the moment and their nearest neighbours (call it after
+// port_index::load), and builds the profit matrix.
+void load();
+
+// Like load, but takes the distances and the paths (e.g. from a save file)
+// instead of searching them. Both are [from_port][to_port], path k is
+// path_points[path_offsets[k]..path_offsets[k + 1]).
+void load(
+    const float *distances, const uint32_t *path_offsets, const Vector2 *path_points
+);
+
+// Recomputes the profit matrix rows and columns of the ports whose prices
+// changed since the last update, and the best routes they affect.
+void update();
+
+// FLT_MAX if the docks are not connected by water or too far apart to be
+// searched.
+float get_distance(int from_port_idx, int to_port_idx);
+// Sea path between the docks, without the start dock and ending at the
+// destination dock. Empty if there is none.
+const std::vector<Vector2> &get_path(int from_port_idx, int to_port_idx);
+float get_profit(int from_port_idx, int to_port_idx, cargo::ProductID product_id);
+
+// The most profitable routes starting at the port, best first. Only
+// routes with a positive profit are included.
+const std::vector<Route> &get_best_routes(int from_port_idx);
+
+}  // namespace routes
+}  // namespace st
@@ -0,0 +1,409 @@
+#include "save.hpp"
+
+#include "components.hpp"
+#include "dynamic_body.hpp"
+#include "economy.hpp"
+#include "entt/entity/fwd.hpp"
+#include "entt/entt.hpp"
+#include "raylib/raylib.h"
+#include "registry.hpp"
+#include "routes.hpp"
+#include "ship.hpp"
+#include "terrain.hpp"
+#include "trader.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+namespace st {
+namespace save {
+
+static const char MAGIC[8] = {'S', 'T', 'S', 'A', 'V', 'E', '\0', '\0'};
+
+// Bump it on any change of the sections, including the layout of the saved
+// components: the loader only accepts its own version.
+static const uint32_t VERSION = 3;
+
+// sections start at multiples of it, so every array is aligned for its type
+static const uint64_t SECTION_ALIGNMENT = 64;
+
+enum class SectionID : uint32_t {
+    TERRAIN_HEIGHTS,
+    TERRAIN_DISTS_TO_WATER,
+    TERRAIN_DISTS_TO_GROUND,
+    // live entities, in the registry's order
+    ENTITIES,
+    // economy::N_STATE_ARRAYS arrays back to back
+    ECONOMY,
+    ROUTE_DISTANCES,
+    ROUTE_PATH_OFFSETS,
+    ROUTE_PATH_POINTS,
+    // per component storage: the packed entities, then the packed components
+    TRANSFORM_ENTITIES,
+    TRANSFORMS,
+    DYNAMIC_BODY_ENTITIES,
+    DYNAMIC_BODIES,
+    SHIP_ENTITIES,
+    SHIPS,
+    PORT_ENTITIES,
+    PORTS,
+    MONEY_ENTITIES,
+    MONEY,
+    TRADER_ENTITIES,
+    TRADERS,
+    PLAYER_ENTITIES,
+    _N_SECTIONS,
+};
+
+static const int N_SECTIONS = (int)SectionID::_N_SECTIONS;
+
+class Header {
+public:
+    char magic[8];
+    uint32_t version;
+    uint32_t n_sections;
+};
+
+// Entry of the section table, which follows the header. Entry i describes
+// the section with id i.
+class Section {
+public:
+    uint32_t id;
+    uint32_t item_size;
+    uint64_t n_items;
+    uint64_t offset;
+};
+
+// ---------------------------------------------------------------
+// Save
+
+// Section contents yet to be written: write puts item_size * n_items bytes
+// into the file.
+class SectionWriter {
+public:
+    uint32_t item_size = 0;
+    uint64_t n_items = 0;
+    std::function<void(std::FILE *)> write;
+};
+
+template <typename T>
+SectionWriter get_array_writer(const T *data, uint64_t n_items) {
+    return {
+        .item_size = sizeof(T),
+        .n_items = n_items,
+        .write = [=](std::FILE *file) { std::fwrite(data, sizeof(T), n_items, file); },
+    };
+}
+
+// Component storages are paged, so they're written page by page.
+template <typename Component>
+void add_storage_writers(
+    std::array<SectionWriter, N_SECTIONS> &writers,
+    SectionID entities_id,
+    SectionID components_id
+) {
+    static_assert(std::is_trivially_copyable_v<Component>);
+    auto &storage = registry::registry.storage<Component>();
+    uint64_t n = storage.size();
+    writers[(int)entities_id] = get_array_writer(storage.data(), n);
+
+    if constexpr (!std::is_empty_v<Component>) {
+        static const size_t page_size = entt::component_traits<Component>::page_size;
+        writers[(int)components_id] = {
+            .item_size = sizeof(Component),
+            .n_items = n,
+            .write =
+                [&storage, n](std::FILE *file) {
+                    for (size_t begin = 0; begin < n; begin += page_size) {
+                        size_t size = std::min<size_t>(page_size, n - begin);
+                        auto page = storage.raw()[begin / page_size];
+                        std::fwrite(page, sizeof(Component), size, file);
+                    }
+                },
+        };
+    }
+}
+
+void save(const std::string &path) {
+    std::array<SectionWriter, N_SECTIONS> writers;
+
+    // terrain
+    uint64_t n_cells = terrain::get_data_size() * terrain::get_data_size();
+    writers[(int)SectionID::TERRAIN_HEIGHTS] = get_array_writer(
+        terrain::get_heights(), n_cells
+    );
+    writers[(int)SectionID::TERRAIN_DISTS_TO_WATER] = get_array_writer(
+        terrain::get_dists_to_water(), n_cells
+    );
+    writers[(int)SectionID::TERRAIN_DISTS_TO_GROUND] = get_array_writer(
+        terrain::get_dists_to_ground(), n_cells
+    );
+
+    // entities
+    auto &entities = registry::registry.storage<entt::entity>();
+    writers[(int)SectionID::ENTITIES] = get_array_writer(
+        entities.data(), entities.free_list()
+    );
+
+    // economy
+    int n_ports = registry::get_ports_group().size();
+    uint64_t n_state_items = cargo::N_PRODUCTS * n_ports;
+    writers[(int)SectionID::ECONOMY] = {
+        .item_size = sizeof(float),
+        .n_items = economy::N_STATE_ARRAYS * n_state_items,
+        .write =
+            [=](std::FILE *file) {
+                for (int i = 0; i < economy::N_STATE_ARRAYS; ++i) {
+                    std::fwrite(
+                        economy::get_state_array(i), sizeof(float), n_state_items, file
+                    );
+                }
+            },
+    };
+
+    // routes, the paths are flattened
+    std::vector<float> distances;
+    std::vector<uint32_t> path_offsets = {0};
+    std::vector<Vector2> path_points;
+    for (int i = 0; i < n_ports; ++i) {
+        for (int j = 0; j < n_ports; ++j) {
+            auto &path = routes::get_path(i, j);
+            distances.push_back(routes::get_distance(i, j));
+            path_points.insert(path_points.end(), path.begin(), path.end());
+            path_offsets.push_back(path_points.size());
+        }
+    }
+    writers[(int)SectionID::ROUTE_DISTANCES] = get_array_writer(
+        distances.data(), distances.size()
+    );
+    writers[(int)SectionID::ROUTE_PATH_OFFSETS] = get_array_writer(
+        path_offsets.data(), path_offsets.size()
+    );
+    writers[(int)SectionID::ROUTE_PATH_POINTS] = get_array_writer(
+        path_points.data(), path_points.size()
+    );
+
+    // components
+    using SID = SectionID;
+    add_storage_writers<components::Transform>(
+        writers, SID::TRANSFORM_ENTITIES, SID::TRANSFORMS
+    );
+    add_storage_writers<dynamic_body::DynamicBody>(
+        writers, SID::DYNAMIC_BODY_ENTITIES, SID::DYNAMIC_BODIES
+    );
+    add_storage_writers<ship::Ship>(writers, SID::SHIP_ENTITIES, SID::SHIPS);
+    add_storage_writers<components::Port>(writers, SID::PORT_ENTITIES, SID::PORTS);
+    add_storage_writers<components::Money>(writers, SID::MONEY_ENTITIES, SID::MONEY);
+    add_storage_writers<trader::Trader>(writers, SID::TRADER_ENTITIES, SID::TRADERS);
+    add_storage_writers<components::Player>(
+        writers, SID::PLAYER_ENTITIES, SID::_N_SECTIONS
+    );
+
+    // layout
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.n_sections = N_SECTIONS;
+
+    std::array<Section, N_SECTIONS> sections;
+    uint64_t offset = sizeof(Header) + sizeof(sections);
+    for (int i = 0; i < N_SECTIONS; ++i) {
+        offset = (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+        sections[i] = {
+            .id = (uint32_t)i,
+            .item_size = writers[i].item_size,
+            .n_items = writers[i].n_items,
+            .offset = offset,
+        };
+        offset += writers[i].item_size * writers[i].n_items;
+    }
+
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) throw std::runtime_error("Failed to open the save file " + path);
+
+    std::fwrite(&header, sizeof(header), 1, file);
+    std::fwrite(sections.data(), sizeof(sections), 1, file);
+    for (int i = 0; i < N_SECTIONS; ++i) {
+        // zero padding up to the section start
+        static const std::array<char, SECTION_ALIGNMENT> padding = {};
+        std::fwrite(padding.data(), 1, sections[i].offset - std::ftell(file), file);
+        if (writers[i].write) writers[i].write(file);
+    }
+
+    bool is_failed = std::ferror(file);
+    is_failed |= std::fclose(file) != 0;
+    if (is_failed) throw std::runtime_error("Failed to write the save file " + path);
+}
+
+// ---------------------------------------------------------------
+// Load
+
+static const std::byte *DATA = nullptr;
+static size_t DATA_SIZE = 0;
+
+// The section's array, checked against the expected item type.
+template <typename T>
+const T *get_section(SectionID id, uint64_t *n_items) {
+    auto sections = (const Section *)(DATA + sizeof(Header));
+    const Section &section = sections[(int)id];
+
+    // the bound is written so that no product can overflow
+    bool is_valid = section.id == (uint32_t)id;
+    is_valid = is_valid && (section.item_size == sizeof(T) || section.n_items == 0);
+    is_valid = is_valid && section.offset % alignof(T) == 0;
+    is_valid = is_valid && section.offset <= DATA_SIZE;
+    is_valid = is_valid && section.n_items <= (DATA_SIZE - section.offset) / sizeof(T);
+    if (!is_valid) {
+        throw std::runtime_error(
+            "Failed to load the save file: bad section " + std::to_string((int)id)
+        );
+    }
+
+    *n_items = section.n_items;
+    return (const T *)(DATA + section.offset);
+}
+
+template <typename Component>
+void load_storage(SectionID entities_id, SectionID components_id) {
+    uint64_t n;
+    auto entities = get_section<entt::entity>(entities_id, &n);
+
+    if constexpr (std::is_empty_v<Component>) {
+        registry::registry.insert<Component>(entities, entities + n);
+    } else {
+        uint64_t n_components;
+        auto components = get_section<Component>(components_id, &n_components);
+        if (n_components != n) {
+            throw std::runtime_error("Failed to load the save file: bad component count");
+        }
+        registry::registry.insert<Component>(entities, entities + n, components);
+    }
+}
+
+void map_file(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) throw std::runtime_error("Failed to open the save file " + path);
+
+    struct stat file_stat;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+        data = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Failed to map the save file " + path);
+    }
+    DATA = (const std::byte *)data;
+    DATA_SIZE = file_stat.st_size;
+}
+
+void check_header() {
+    bool is_valid = DATA_SIZE >= sizeof(Header) + N_SECTIONS * sizeof(Section);
+    auto header = (const Header *)DATA;
+    is_valid = is_valid && std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0;
+    is_valid = is_valid && header->version == VERSION;
+    is_valid = is_valid && header->n_sections == N_SECTIONS;
+    if (!is_valid) {
+        throw std::runtime_error(
+            "Failed to load the save file: not a save of this version"
+        );
+    }
+}
+
+void load(const std::string &path) {
+    unload();
+    map_file(path);
+    check_header();
+
+    // terrain, used in place
+    uint64_t n_cells = terrain::get_data_size() * terrain::get_data_size();
+    uint64_t n_heights, n_dists_to_water, n_dists_to_ground;
+    auto heights = get_section<float>(SectionID::TERRAIN_HEIGHTS, &n_heights);
+    auto dists_to_water = get_section<float>(
+        SectionID::TERRAIN_DISTS_TO_WATER, &n_dists_to_water
+    );
+    auto dists_to_ground = get_section<float>(
+        SectionID::TERRAIN_DISTS_TO_GROUND, &n_dists_to_ground
+    );
+    if (n_heights != n_cells || n_dists_to_water != n_cells
+        || n_dists_to_ground != n_cells) {
+        throw std::runtime_error("Failed to load the save file: bad terrain size");
+    }
+    terrain::load(heights, dists_to_water, dists_to_ground);
+
+    // entities keep their ids, so the component sections can refer to them
+    uint64_t n_entities;
+    auto entities = get_section<entt::entity>(SectionID::ENTITIES, &n_entities);
+    for (uint64_t i = 0; i < n_entities; ++i) {
+        if (registry::registry.create(entities[i]) != entities[i]) {
+            throw std::runtime_error("Failed to load the save file: world isn't empty");
+        }
+    }
+
+    // the group completing components go last, and ports are inserted in the
+    // saved order: it's the ports group order all port indices refer to
+    using SID = SectionID;
+    load_storage<components::Transform>(SID::TRANSFORM_ENTITIES, SID::TRANSFORMS);
+    load_storage<dynamic_body::DynamicBody>(
+        SID::DYNAMIC_BODY_ENTITIES, SID::DYNAMIC_BODIES
+    );
+    load_storage<components::Money>(SID::MONEY_ENTITIES, SID::MONEY);
+    load_storage<trader::Trader>(SID::TRADER_ENTITIES, SID::TRADERS);
+    load_storage<components::Player>(SID::PLAYER_ENTITIES, SID::_N_SECTIONS);
+    load_storage<components::Port>(SID::PORT_ENTITIES, SID::PORTS);
+    load_storage<ship::Ship>(SID::SHIP_ENTITIES, SID::SHIPS);
+
+    // economy
+    int n_ports = registry::get_ports_group().size();
+    uint64_t n_state_items = cargo::N_PRODUCTS * n_ports;
+    uint64_t n_economy_items;
+    auto economy_data = get_section<float>(SectionID::ECONOMY, &n_economy_items);
+    if (n_economy_items != economy::N_STATE_ARRAYS * n_state_items) {
+        throw std::runtime_error("Failed to load the save file: bad economy size");
+    }
+    std::array<const float *, economy::N_STATE_ARRAYS> state_arrays;
+    for (int i = 0; i < economy::N_STATE_ARRAYS; ++i) {
+        state_arrays[i] = economy_data + i * n_state_items;
+    }
+    economy::load(state_arrays.data());
+
+    // routes
+    uint64_t n_pairs = n_ports * n_ports;
+    uint64_t n_distances, n_path_offsets, n_path_points;
+    auto distances = get_section<float>(SectionID::ROUTE_DISTANCES, &n_distances);
+    auto path_offsets = get_section<uint32_t>(
+        SectionID::ROUTE_PATH_OFFSETS, &n_path_offsets
+    );
+    auto path_points = get_section<Vector2>(SectionID::ROUTE_PATH_POINTS, &n_path_points);
+    bool is_valid = n_distances == n_pairs && n_path_offsets == n_pairs + 1;
+    is_valid = is_valid && path_offsets[0] == 0;
+    is_valid = is_valid && path_offsets[n_pairs] == n_path_points;
+    is_valid = is_valid && std::is_sorted(path_offsets, path_offsets + n_pairs + 1);
+    if (!is_valid) {
+        throw std::runtime_error("Failed to load the save file: bad routes size");
+    }
+    routes::load(distances, path_offsets, path_points);
+}
+
+void unload() {
+    if (!DATA) return;
+    munmap((void *)DATA, DATA_SIZE);
+    DATA = nullptr;
+    DATA_SIZE = 0;
+}
+
+}  // namespace save
+}  // namespace st
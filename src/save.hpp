@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+
+namespace st {
+namespace save {
+
+// Writes the world to a binary file: the terrain grids, all entities with
+// their components (cargo and money included), the market state and the
+// routes. The file is a header, a section table and the sections, each one a
+// raw array aligned for use in place.
+void save(const std::string &path);
+
+// Maps the file and builds the world from it, in place of generating one:
+// the terrain grids are used right from the mapping, the rest is copied
+// with no parsing. Throws if the file is not a save of this version. The
+// mapping stays until unload.
+void load(const std::string &path);
+void unload();
+
+}  // namespace save
+}  // namespace st
@@ -0,0 +1,103 @@
+#include "scheduler.hpp"
+
+#include "jobs.hpp"
+#include "profiler.hpp"
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace st {
+namespace scheduler {
+
+class System {
+public:
+    std::string name;
+    Access reads;
+    Access writes;
+    std::function<void()> fn;
+
+    int n_dependencies = 0;
+    std::vector<int> dependents;
+
+    System(std::string name, Access reads, Access writes, std::function<void()> fn)
+        : name(name)
+        , reads(reads)
+        , writes(writes)
+        , fn(fn) {}
+
+    bool check_if_conflicts(const System &other) const {
+        return (this->writes & (other.reads | other.writes)).any()
+               || (other.writes & this->reads).any();
+    }
+};
+
+static int N_COMPONENTS = 0;
+
+static std::vector<System> SYSTEMS;
+static bool IS_BUILT = false;
+
+static std::unique_ptr<std::atomic<int>[]> N_WAITING;
+
+int get_next_component_idx() {
+    if (N_COMPONENTS == MAX_N_COMPONENTS) {
+        throw std::runtime_error("Failed to register component: too many components");
+    }
+
+    return N_COMPONENTS++;
+}
+
+void add_system(std::string name, Access reads, Access writes, std::function<void()> fn) {
+    if (IS_BUILT) {
+        throw std::runtime_error("Failed to add system " + name + ": graph is built");
+    }
+
+    SYSTEMS.emplace_back(name, reads, writes, fn);
+}
+
+void build() {
+    for (size_t i = 0; i < SYSTEMS.size(); ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            if (!SYSTEMS[i].check_if_conflicts(SYSTEMS[j])) continue;
+            SYSTEMS[i].n_dependencies += 1;
+            SYSTEMS[j].dependents.push_back(i);
+        }
+    }
+
+    N_WAITING = std::make_unique<std::atomic<int>[]>(SYSTEMS.size());
+    IS_BUILT = true;
+}
+
+// Runs the system and submits its dependents that became ready. They are
+// added to the same handle before this job completes, so the handle can't
+// finish early.
+void run_system(int idx, jobs::Handle handle) {
+    auto &system = SYSTEMS[idx];
+
+    profiler::push(system.name);
+    system.fn();
+    profiler::pop();
+
+    for (int dependent : system.dependents) {
+        if (--N_WAITING[dependent] != 0) continue;
+        jobs::submit([dependent, handle] { run_system(dependent, handle); }, handle);
+    }
+}
+
+void run() {
+    if (!IS_BUILT) build();
+
+    jobs::Handle handle;
+    for (size_t i = 0; i < SYSTEMS.size(); ++i) {
+        N_WAITING[i] = SYSTEMS[i].n_dependencies;
+    }
+    for (size_t i = 0; i < SYSTEMS.size(); ++i) {
+        if (SYSTEMS[i].n_dependencies != 0) continue;
+        jobs::submit([i, handle] { run_system(i, handle); }, handle);
+    }
+
+    jobs::wait(handle);
+}
+
+}  // namespace scheduler
+}  // namespace st
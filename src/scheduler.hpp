@@ -0,0 +1,42 @@
+#pragma once
+
+#include <bitset>
+#include <functional>
+#include <string>
+
+namespace st {
+namespace scheduler {
+
+static const int MAX_N_COMPONENTS = 64;
+
+using Access = std::bitset<MAX_N_COMPONENTS>;
+
+int get_next_component_idx();
+
+template <typename Component>
+int get_component_idx() {
+    static const int idx = get_next_component_idx();
+    return idx;
+}
+
+// Set of components a system reads or writes, e.g.
+// access<components::Transform, dynamic_body::DynamicBody>().
+template <typename... Components>
+Access access() {
+    Access mask;
+    (mask.set(get_component_idx<Components>()), ...);
+    return mask;
+}
+
+// Systems are added once and then run every tick. A system waits for every
+// previously added system it conflicts with (one of them writes what the other
+// one reads or writes), non-conflicting systems run in parallel on the job
+// system.
+void add_system(std::string name, Access reads, Access writes, std::function<void()> fn);
+void build();
+
+// Runs all systems once and returns when they are done. Not reentrant.
+void run();
+
+}  // namespace scheduler
+}  // namespace st
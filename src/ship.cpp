@@ -3,53 +3,102 @@
 #include "cargo.hpp"
 #include "components.hpp"
 #include "dynamic_body.hpp"
-#include "registry.hpp"
+#include "input.hpp"
+#include "raylib/raylib.h"
+#include "raylib/raymath.h"
+#include <algorithm>
+#include <cmath>
 
 namespace st {
 namespace ship {
 
-Ship::Ship(entt::entity entity, ControllerType controller_type, cargo::Cargo cargo)
-    : entity(entity)
-    , controller_type(controller_type)
-    , cargo(cargo) {}
+// the trader controller turns while the target is off by more than
+// STEER_DEADBAND radians, and only sails forward within MAX_SAIL_ANGLE
+static const float STEER_DEADBAND = 0.05;
+static const float MAX_SAIL_ANGLE = 0.5;
 
-void Ship::move(bool is_forward) {
-    auto &body = registry::registry.get<dynamic_body::DynamicBody>(this->entity);
-    auto transform = registry::registry.get<components::Transform>(this->entity);
+Ship::Ship(ControllerType controller_type, const cargo::Cargo &cargo)
+    : controller_type(controller_type)
+    , cargo(cargo) {}
 
+void Ship::move(
+    components::Transform &transform, dynamic_body::DynamicBody &body, bool is_forward
+) {
     Vector2 forward = transform.get_forward();
     int sign = is_forward ? 1 : -1;
 
     body.apply_force(forward, sign * this->force);
 }
 
-void Ship::rotate(bool is_right) {
-    auto &body = registry::registry.get<dynamic_body::DynamicBody>(this->entity);
-
+void Ship::rotate(dynamic_body::DynamicBody &body, bool is_right) {
     int sign = is_right ? 1 : -1;
 
     body.apply_torque(sign * this->torque);
 }
 
-void Ship::update_controller_manual() {
-    if (IsKeyDown(KEY_A)) this->rotate(false);
-    if (IsKeyDown(KEY_D)) this->rotate(true);
+void Ship::update_controller_manual(
+    components::Transform &transform, dynamic_body::DynamicBody &body
+) {
+    if (input::is_key_down(KEY_A)) this->rotate(body, false);
+    if (input::is_key_down(KEY_D)) this->rotate(body, true);
 
-    if (IsKeyDown(KEY_W)) this->move(true);
-    if (IsKeyDown(KEY_S)) this->move(false);
+    if (input::is_key_down(KEY_W)) this->move(transform, body, true);
+    if (input::is_key_down(KEY_S)) this->move(transform, body, false);
 }
 
-void Ship::update_controller_dummy() {
-    this->rotate(true);
-    this->move(true);
+void Ship::update_controller_dummy(
+    components::Transform &transform, dynamic_body::DynamicBody &body
+) {
+    this->rotate(body, true);
+    this->move(transform, body, true);
+}
+
+void Ship::update_controller_trader(
+    components::Transform &transform, dynamic_body::DynamicBody &body
+) {
+    Vector2 forward = transform.get_forward();
+    Vector2 to_target = Vector2Subtract(this->target_position, transform.position);
+    float cross = forward.x * to_target.y - forward.y * to_target.x;
+    float angle = atan2f(cross, Vector2DotProduct(forward, to_target));
+
+    if (angle > STEER_DEADBAND) this->rotate(body, true);
+    else if (angle < -STEER_DEADBAND) this->rotate(body, false);
+
+    if (fabsf(angle) < MAX_SAIL_ANGLE) this->move(transform, body, true);
 }
 
-void Ship::update() {
+void Ship::update(components::Transform &transform, dynamic_body::DynamicBody &body) {
     switch (this->controller_type) {
-        case ControllerType::MANUAL: this->update_controller_manual(); break;
-        case ControllerType::DUMMY: this->update_controller_dummy(); break;
+        case ControllerType::MANUAL:
+            this->update_controller_manual(transform, body);
+            break;
+        case ControllerType::DUMMY:
+            this->update_controller_dummy(transform, body);
+            break;
+        case ControllerType::TRADER:
+        case ControllerType::FERRY:
+            this->update_controller_trader(transform, body);
+            break;
     }
 }
 
+void Ship::advance(
+    components::Transform &transform, dynamic_body::DynamicBody &body, float dt
+) {
+    Vector2 to_target = Vector2Subtract(this->target_position, transform.position);
+    float dist = Vector2Length(to_target);
+    if (dist < EPSILON) return;
+
+    // the speed at which the forward force is balanced by the damping
+    float speed = this->force / body.linear_damping;
+    Vector2 direction = Vector2Scale(to_target, 1.0 / dist);
+    float step = std::min(speed * dt, dist);
+
+    transform.position = Vector2Add(transform.position, Vector2Scale(direction, step));
+    transform.rotation = atan2f(direction.y, direction.x);
+    body.linear_velocity = Vector2Scale(direction, speed);
+    body.angular_velocity = 0.0;
+}
+
 }  // namespace ship
 }  // namespace st
@@ -1,8 +1,8 @@
 #pragma once
 
 #include "cargo.hpp"
-#include "entt/entity/fwd.hpp"
-#include "entt/entt.hpp"
+#include "components.hpp"
+#include "dynamic_body.hpp"
 
 namespace st {
 namespace ship {
@@ -10,27 +10,48 @@ namespace ship {
 enum class ControllerType {
     MANUAL,
     DUMMY,
+    // both steer toward target_position, which is set by the trader AI
+    // (trader::Trader) or by the ferry's behaviour task respectively
+    TRADER,
+    FERRY,
 };
 
 class Ship {
 private:
-    void move(bool is_forward);
-    void rotate(bool is_right);
-
-    void update_controller_manual();
-    void update_controller_dummy();
+    void move(
+        components::Transform &transform, dynamic_body::DynamicBody &body, bool is_forward
+    );
+    void rotate(dynamic_body::DynamicBody &body, bool is_right);
+
+    void update_controller_manual(
+        components::Transform &transform, dynamic_body::DynamicBody &body
+    );
+    void update_controller_dummy(
+        components::Transform &transform, dynamic_body::DynamicBody &body
+    );
+    void update_controller_trader(
+        components::Transform &transform, dynamic_body::DynamicBody &body
+    );
 
 public:
-    entt::entity entity;
     ControllerType controller_type;
 
     cargo::Cargo cargo;
     float torque = 30.0;
     float force = 4000.0;
+    Vector2 target_position = {0.0, 0.0};
+
+    Ship(ControllerType controller_type, const cargo::Cargo &cargo);
 
-    Ship(entt::entity entity, ControllerType controller_type, cargo::Cargo);
+    void update(components::Transform &transform, dynamic_body::DynamicBody &body);
 
-    void update();
+    // Moves the ship straight toward target_position at its cruise speed,
+    // bypassing the controller, the forces and the terrain check. Only for
+    // ships following a route path (traders and ferries), whose segments are
+    // known to be water.
+    void advance(
+        components::Transform &transform, dynamic_body::DynamicBody &body, float dt
+    );
 };
 
 }  // namespace ship
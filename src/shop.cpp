@@ -6,12 +6,14 @@
 #include "raylib/raylib.h"
 #include "registry.hpp"
 #include "ship.hpp"
+#include "trade.hpp"
 #include "ui.hpp"
 #include <algorithm>
 #include <array>
+#include <charconv>
 #include <climits>
 #include <cstdio>
-#include <string>
+#include <string_view>
 
 namespace st {
 namespace shop {
@@ -20,7 +22,9 @@ static int SELECTED_PRODUCT_IDX = -1;
 static bool IS_OPENED = false;
 static entt::entity PORT_ENTITY;
 static cargo::Cargo *SHIP_CARGO_P;
+static components::Port *PORT_P;
 static cargo::Cargo *PORT_CARGO_P;
+static cargo::Prices *PORT_PRICES_P;
 static cargo::Cargo SHIP_CARGO_ORIG;
 static components::Money *SHIP_MONEY_P;
 static components::Money *PORT_MONEY_P;
@@ -42,7 +46,9 @@ void open(entt::entity port_entity) {
     PORT_MONEY_ORIG = *PORT_MONEY_P;
 
     SHIP_CARGO_P = &ship.cargo;
+    PORT_P = &port;
     PORT_CARGO_P = &port.cargo;
+    PORT_PRICES_P = &port.prices;
 
     IS_OPENED = true;
 }
@@ -84,6 +90,50 @@ const static float TRADE_BUTTON_HEIGHT = 50.0;
 
 const static float FINAL_BUTTONS_CLOTHENESS = 0.2;
 
+// Text built in a fixed stack buffer, so drawing the shop doesn't allocate.
+// Anything past the buffer size is cut off.
+class Text {
+private:
+    std::array<char, 64> data;
+    int length = 0;
+
+public:
+    Text() {
+        this->data[0] = '\0';
+    }
+
+    Text(std::string_view str)
+        : Text() {
+        this->append(str);
+    }
+
+    Text(int value)
+        : Text() {
+        this->append(value);
+    }
+
+    Text &append(std::string_view str) {
+        int n = std::min<int>(str.size(), this->data.size() - 1 - this->length);
+        str.copy(this->data.data() + this->length, n);
+        this->length += n;
+        this->data[this->length] = '\0';
+        return *this;
+    }
+
+    Text &append(int value) {
+        char *first = this->data.data() + this->length;
+        char *last = this->data.data() + this->data.size() - 1;
+        auto [ptr, ec] = std::to_chars(first, last, value);
+        if (ec == std::errc()) this->length = ptr - this->data.data();
+        this->data[this->length] = '\0';
+        return *this;
+    }
+
+    const char *c_str() const {
+        return this->data.data();
+    }
+};
+
 enum class Pivot {
     MID_MID,
     MID_TOP,
@@ -124,9 +174,9 @@ Rectangle get_middle_square(Rectangle rect, float pad) {
 }
 
 Vector2 get_text_top_left(
-    std::string text, int font_size, Vector2 position, Pivot pivot
+    const char *text, int font_size, Vector2 position, Pivot pivot
 ) {
-    float width = MeasureText(text.c_str(), font_size);
+    float width = MeasureText(text, font_size);
     Rectangle rect = {
         .x = position.x,
         .y = position.y,
@@ -138,47 +188,44 @@ Vector2 get_text_top_left(
     return {rect.x, rect.y};
 }
 
-void draw_text_in_rect(Rectangle rect, std::string text, int font_size, Color color) {
+// Text together with its measured position. It's rebuilt only when the
+// key (the values the text is made of) changes or the layout is invalidated.
+class CachedText {
+public:
+    Text text;
+    Vector2 top_left;
+    std::array<int, 2> key;
+    bool is_dirty = true;
+};
+
+template <typename BuildText>
+const CachedText &update_text(
+    CachedText &cached,
+    Rectangle rect,
+    int font_size,
+    std::array<int, 2> key,
+    BuildText build_text
+) {
+    if (!cached.is_dirty && cached.key == key) return cached;
+
     Vector2 center = {
         .x = rect.x + 0.5f * rect.width,
         .y = rect.y + 0.5f * rect.height,
     };
-    Vector2 top_left = get_text_top_left(text, font_size, center, Pivot::MID_MID);
-    DrawText(text.c_str(), top_left.x, top_left.y, font_size, color);
+    cached.text = build_text();
+    cached.top_left = get_text_top_left(
+        cached.text.c_str(), font_size, center, Pivot::MID_MID
+    );
+    cached.key = key;
+    cached.is_dirty = false;
+
+    return cached;
 }
 
-Rectangle split_and_draw_outer_border(Rectangle rect) {
-    // top
-    Rectangle border = rect;
-    border.height = BORDER;
-    DrawRectangleRec(border, ui::color::BORDER);
-
-    // right
-    border = rect;
-    border.x += border.width - BORDER;
-    border.width = BORDER;
-    DrawRectangleRec(border, ui::color::BORDER);
-
-    // bot
-    border = rect;
-    border.y += border.height - BORDER;
-    border.height = BORDER;
-    DrawRectangleRec(border, ui::color::BORDER);
-
-    // left
-    border = rect;
-    border.width = BORDER;
-    DrawRectangleRec(border, ui::color::BORDER);
-
-    // erode rect
-    rect = {
-        .x = rect.x + BORDER,
-        .y = rect.y + BORDER,
-        .width = rect.width - 2.0f * BORDER,
-        .height = rect.height - 2.0f * BORDER,
-    };
-
-    return rect;
+void draw_text(const CachedText &cached, int font_size, Color color) {
+    DrawText(
+        cached.text.c_str(), cached.top_left.x, cached.top_left.y, font_size, color
+    );
 }
 
 struct RectangleSplit2 {
@@ -237,53 +284,275 @@ RectangleSplit3 split_left(Rectangle rect, float left_size, float mid_size) {
     return split;
 }
 
-RectangleSplit2 split_top_and_draw_mid(
-    Rectangle rect, float top_size, float mid_size, Color mid_color
-) {
-    RectangleSplit3 split = split_top(rect, top_size, mid_size);
-    DrawRectangleRec(split.rect1, mid_color);
-    return {.rect0 = split.rect0, .rect1 = split.rect2};
+// -----------------------------------------------------------------------
+// layout
+// The shop table is retained between frames: rectangles are recomputed only
+// when the screen size changes, and each frame replays them.
+const static int N_COLS = 5;
+const static int N_ROWS = cargo::N_PRODUCTS;
+const static int MAX_N_BORDERS = 8 + (N_COLS + 1) * (N_ROWS + 1);
+
+class StatsCellLayout {
+public:
+    Rectangle rect;
+    Rectangle who_rect;
+    Rectangle cap_rect;
+    Rectangle gold_rect;
+};
+
+class Layout {
+public:
+    int screen_width = -1;
+    int screen_height = -1;
+
+    std::array<Rectangle, MAX_N_BORDERS> borders;
+    int n_borders = 0;
+
+    std::array<Rectangle, N_COLS> header_cells;
+    std::array<Rectangle, N_ROWS> rows;
+    std::array<std::array<Rectangle, N_COLS>, N_ROWS> cells;
+    std::array<Rectangle, N_ROWS> buy_buttons;
+    std::array<Rectangle, N_ROWS> sell_buttons;
+
+    StatsCellLayout ship_stats;
+    StatsCellLayout port_stats;
+
+    Rectangle buttons_cell;
+    Rectangle summary_rect;
+    Rectangle accept_button;
+    Rectangle cancel_button;
+};
+
+class StatsCellTexts {
+public:
+    CachedText who;
+    CachedText capacity;
+    CachedText money;
+};
+
+class Texts {
+public:
+    std::array<CachedText, N_COLS> header_cells;
+    std::array<std::array<CachedText, N_COLS>, N_ROWS> cells;
+    StatsCellTexts ship_stats;
+    StatsCellTexts port_stats;
+    CachedText summary;
+};
+
+static Layout LAYOUT;
+static Texts TEXTS;
+
+void add_border(Rectangle rect) {
+    LAYOUT.borders[LAYOUT.n_borders++] = rect;
 }
 
-RectangleSplit2 split_bot_and_draw_mid(
-    Rectangle rect, float bot_size, float mid_size, Color mid_color
-) {
-    RectangleSplit3 split = split_bot(rect, bot_size, mid_size);
-    DrawRectangleRec(split.rect1, mid_color);
+Rectangle split_outer_border(Rectangle rect) {
+    // top
+    Rectangle border = rect;
+    border.height = BORDER;
+    add_border(border);
+
+    // right
+    border = rect;
+    border.x += border.width - BORDER;
+    border.width = BORDER;
+    add_border(border);
+
+    // bot
+    border = rect;
+    border.y += border.height - BORDER;
+    border.height = BORDER;
+    add_border(border);
+
+    // left
+    border = rect;
+    border.width = BORDER;
+    add_border(border);
+
+    // erode rect
+    rect = {
+        .x = rect.x + BORDER,
+        .y = rect.y + BORDER,
+        .width = rect.width - 2.0f * BORDER,
+        .height = rect.height - 2.0f * BORDER,
+    };
+
+    return rect;
+}
+
+RectangleSplit2 split_top_with_border(Rectangle rect, float top_size) {
+    RectangleSplit3 split = split_top(rect, top_size, BORDER);
+    add_border(split.rect1);
     return {.rect0 = split.rect0, .rect1 = split.rect2};
 }
 
-RectangleSplit2 split_left_and_draw_mid(
-    Rectangle rect, float left_size, float mid_size, Color mid_color
-) {
-    RectangleSplit3 split = split_left(rect, left_size, mid_size);
-    DrawRectangleRec(split.rect1, mid_color);
+RectangleSplit2 split_bot_with_border(Rectangle rect, float bot_size) {
+    RectangleSplit3 split = split_bot(rect, bot_size, BORDER);
+    add_border(split.rect1);
     return {.rect0 = split.rect0, .rect1 = split.rect2};
 }
 
-RectangleSplit2 split_left_and_draw_border(Rectangle rect, float left_size) {
-    return split_left_and_draw_mid(rect, left_size, BORDER, ui::color::BORDER);
+RectangleSplit2 split_left_with_border(Rectangle rect, float left_size) {
+    RectangleSplit3 split = split_left(rect, left_size, BORDER);
+    add_border(split.rect1);
+    return {.rect0 = split.rect0, .rect1 = split.rect2};
 }
 
 float get_col_width(int col_idx, float full_width) {
-    static const int n_cols = 5;
     static const int product_col_idx = 2;
     static const float product_col_scale = 1.8;
 
-    float col_width = (full_width - BORDER * (n_cols - 1)) / n_cols;
+    float col_width = (full_width - BORDER * (N_COLS - 1)) / N_COLS;
 
     if (col_idx == product_col_idx) {
         col_width *= product_col_scale;
     } else {
-        col_width -= col_width * (product_col_scale - 1.0) / (n_cols - 1);
+        col_width -= col_width * (product_col_scale - 1.0) / (N_COLS - 1);
     }
 
     return col_width;
 }
 
-void draw_header(Rectangle rect) {
-    static const int n_cols = 5;
-    static std::array<std::string, n_cols> col_names = {
+void update_cols_layout(Rectangle rect, std::array<Rectangle, N_COLS> &cells) {
+    float full_width = rect.width;
+    for (int i = 0; i < N_COLS; ++i) {
+        float col_width = get_col_width(i, full_width);
+        RectangleSplit2 split = split_left_with_border(rect, col_width);
+        cells[i] = split.rect0;
+        rect = split.rect1;
+    }
+}
+
+void update_rows_layout(Rectangle rect) {
+    float row_height = (rect.height - BORDER * (N_ROWS - 1)) / N_ROWS;
+
+    for (int i = 0; i < N_ROWS; ++i) {
+        RectangleSplit2 split = split_top_with_border(rect, row_height);
+        LAYOUT.rows[i] = split.rect0;
+        update_cols_layout(split.rect0, LAYOUT.cells[i]);
+        rect = split.rect1;
+
+        Rectangle product_rect = LAYOUT.cells[i][2];
+        float icon_size = product_rect.height - 2.0 * PAD;
+        Rectangle dst = {
+            .x = product_rect.x + PAD,
+            .y = product_rect.y + PAD,
+            .width = icon_size,
+            .height = icon_size,
+        };
+        LAYOUT.buy_buttons[i] = dst;
+
+        dst.x = product_rect.x + product_rect.width - PAD - icon_size;
+        LAYOUT.sell_buttons[i] = dst;
+    }
+}
+
+StatsCellLayout get_stats_cell_layout(Rectangle rect) {
+    StatsCellLayout layout;
+    layout.rect = rect;
+
+    float row_height = rect.height / 3.0;
+    RectangleSplit3 split = split_top(rect, row_height, 0.0);
+    layout.who_rect = split.rect0;
+    rect = split.rect2;
+
+    split = split_top(rect, row_height, 0.0);
+    layout.cap_rect = split.rect0;
+    layout.gold_rect = split.rect2;
+
+    return layout;
+}
+
+void update_buttons_cell_layout(Rectangle rect) {
+    LAYOUT.buttons_cell = rect;
+
+    float row_height = rect.height / 2.0;
+    RectangleSplit3 split = split_top(rect, row_height, 0.0);
+
+    Rectangle buttons_rect = split.rect2;
+    buttons_rect.x += buttons_rect.width * FINAL_BUTTONS_CLOTHENESS;
+    buttons_rect.width -= buttons_rect.width * 2.0 * FINAL_BUTTONS_CLOTHENESS;
+    LAYOUT.summary_rect = split.rect0;
+
+    split = split_left(buttons_rect, 0.5 * buttons_rect.width, 0.0);
+    LAYOUT.accept_button = get_middle_square(split.rect0, PAD);
+    LAYOUT.cancel_button = get_middle_square(split.rect2, PAD);
+}
+
+void update_footer_layout(Rectangle rect) {
+    float full_width = rect.width;
+
+    float col_width = get_col_width(0, full_width);
+    RectangleSplit2 split = split_left_with_border(rect, 2.0 * col_width + BORDER);
+    Rectangle ship_rect = split.rect0;
+    rect = split.rect1;
+
+    col_width = get_col_width(2, full_width);
+    split = split_left_with_border(rect, col_width);
+    Rectangle buttons_rect = split.rect0;
+    Rectangle port_rect = split.rect1;
+
+    LAYOUT.ship_stats = get_stats_cell_layout(ship_rect);
+    LAYOUT.port_stats = get_stats_cell_layout(port_rect);
+    update_buttons_cell_layout(buttons_rect);
+}
+
+void update_layout(int screen_width, int screen_height) {
+    if (LAYOUT.screen_width == screen_width && LAYOUT.screen_height == screen_height) {
+        return;
+    }
+
+    LAYOUT = Layout();
+    LAYOUT.screen_width = screen_width;
+    LAYOUT.screen_height = screen_height;
+
+    // all measured text positions are relative to the old layout
+    TEXTS = Texts();
+
+    Rectangle rect = {
+        .x = 0.5f * (screen_width - WINDOW_WIDTH),
+        .y = 0.5f * (screen_height - WINDOW_HEIGHT),
+        .width = WINDOW_WIDTH,
+        .height = WINDOW_HEIGHT,
+    };
+
+    RectangleSplit2 split;
+
+    rect = split_outer_border(rect);
+    split = split_top_with_border(rect, HEADER_HEIGHT);
+    Rectangle header_rect = split.rect0;
+
+    split = split_bot_with_border(split.rect1, FOOTER_HEIGHT);
+    Rectangle rows_rect = split.rect0;
+    Rectangle footer_rect = split.rect1;
+
+    update_cols_layout(header_rect, LAYOUT.header_cells);
+    update_rows_layout(rows_rect);
+    update_footer_layout(footer_rect);
+}
+
+// -----------------------------------------------------------------------
+// draw
+void draw_backgrounds() {
+    // row backgrounds double as the product selectors
+    for (int i = 0; i < N_ROWS; ++i) {
+        ui::radio_button_rect(LAYOUT.rows[i], &SELECTED_PRODUCT_IDX, i);
+    }
+
+    for (auto &rect : LAYOUT.header_cells) {
+        DrawRectangleRec(rect, ui::color::RECT_COLD);
+    }
+    DrawRectangleRec(LAYOUT.ship_stats.rect, ui::color::RECT_COLD);
+    DrawRectangleRec(LAYOUT.port_stats.rect, ui::color::RECT_COLD);
+    DrawRectangleRec(LAYOUT.buttons_cell, ui::color::RECT_COLD);
+
+    for (int i = 0; i < LAYOUT.n_borders; ++i) {
+        DrawRectangleRec(LAYOUT.borders[i], ui::color::BORDER);
+    }
+}
+
+void draw_header() {
+    static constexpr std::array<const char *, N_COLS> col_names = {
         "Ship",
         "Sell Price",
         "Product",
@@ -291,21 +560,19 @@ void draw_header(Rectangle rect) {
         "Port",
     };
 
-    float full_width = rect.width;
-    for (int i = 0; i < n_cols; ++i) {
-        float col_width = get_col_width(i, full_width);
-        auto text = col_names[i];
-        RectangleSplit2 split = split_left_and_draw_border(rect, col_width);
-        rect = split.rect1;
-
-        DrawRectangleRec(split.rect0, ui::color::RECT_COLD);
-        draw_text_in_rect(split.rect0, text, LARGE_FONT_SIZE, ui::color::TEXT_LIGHT);
+    for (int i = 0; i < N_COLS; ++i) {
+        auto &text = update_text(
+            TEXTS.header_cells[i],
+            LAYOUT.header_cells[i],
+            LARGE_FONT_SIZE,
+            {0, 0},
+            [&] { return Text(col_names[i]); }
+        );
+        draw_text(text, LARGE_FONT_SIZE, ui::color::TEXT_LIGHT);
     }
 }
 
-void draw_row(Rectangle rect, int row_idx) {
-    static const int n_cols = 5;
-
+void draw_row(int row_idx) {
     int font_size = MEDIUM_FONT_SIZE;
 
     Color text_color;
@@ -315,178 +582,124 @@ void draw_row(Rectangle rect, int row_idx) {
         text_color = ui::color::TEXT_MILD;
     }
 
-    float full_width = rect.width;
-    for (int i = 0; i < n_cols; ++i) {
-        float col_width = get_col_width(i, full_width);
-        RectangleSplit2 split = split_left_and_draw_border(rect, col_width);
-        Rectangle cell_rect = split.rect0;
-        rect = split.rect1;
+    auto product_id = (cargo::ProductID)row_idx;
+    int ship_n_units = SHIP_CARGO_P->get_n_units(product_id);
+    int port_n_units = PORT_CARGO_P->get_n_units(product_id);
+    int port_buy_price = PORT_PRICES_P->get_buy_price(product_id);
+    int port_sell_price = PORT_PRICES_P->get_sell_price(product_id);
 
-        std::string text;
-        auto ship_product = &SHIP_CARGO_P->products[row_idx];
-        auto port_product = &PORT_CARGO_P->products[row_idx];
-        switch (i) {
-            case 0: {  // ship amount
-                text = std::to_string(ship_product->n_units);
-                draw_text_in_rect(cell_rect, text, font_size, text_color);
-                break;
-            }
-            case 1: {  // ship sell price (port buy price)
-                int port_buy_price = port_product->get_sell_price();
-                text = std::to_string(port_buy_price);
-                draw_text_in_rect(cell_rect, text, font_size, text_color);
-                break;
-            }
-            case 2: {  // product
-                if (SELECTED_PRODUCT_IDX == row_idx) {
-                    float icon_size = cell_rect.height - 2.0 * PAD;
-                    Rectangle dst = {
-                        .x = cell_rect.x + PAD,
-                        .y = cell_rect.y + PAD,
-                        .width = icon_size,
-                        .height = icon_size,
-                    };
-
-                    int speed;
-                    if (IsKeyDown(KEY_LEFT_CONTROL)) {
-                        speed = 10;
-                    } else if (IsKeyDown(KEY_LEFT_SHIFT)) {
-                        speed = port_product->n_units + ship_product->n_units;
-                    } else {
-                        speed = 1;
-                    }
-
-                    // buy
-                    int ship_increment_n = ui::increment_button_sprite(
-                        ui::SpriteName::LEFT_ARROW_ICON, dst, speed
-                    );
-
-                    int ship_has_cargo_for_n = SHIP_CARGO_P->get_free_weight()
-                                               / port_product->unit_weight;
-                    int ship_has_money_for_n = SHIP_MONEY_P->value
-                                               / port_product->get_sell_price();
-                    int ship_max_n_buy = std::min(
-                        ship_has_cargo_for_n, port_product->n_units
-                    );
-                    ship_max_n_buy = std::min(ship_has_money_for_n, ship_max_n_buy);
-                    ship_increment_n = std::min(ship_increment_n, ship_max_n_buy);
-
-                    // sell
-                    dst.x = cell_rect.x + cell_rect.width - PAD - icon_size;
-                    int port_increment_n = ui::increment_button_sprite(
-                        ui::SpriteName::RIGHT_ARROW_ICON, dst, speed
-                    );
-
-                    int port_has_cargo_for_n = PORT_CARGO_P->get_free_weight()
-                                               / port_product->unit_weight;
-                    int port_has_money_for_n = PORT_MONEY_P->value
-                                               / port_product->get_buy_price();
-                    int port_max_n_buy = std::min(
-                        port_has_cargo_for_n, ship_product->n_units
-                    );
-                    port_max_n_buy = std::min(port_has_money_for_n, port_max_n_buy);
-                    port_increment_n = std::min(port_increment_n, port_max_n_buy);
-
-                    // apply changes
-                    int ship_money_spent = ship_increment_n
-                                           * port_product->get_sell_price();
-                    int ship_money_received = port_increment_n
-                                              * port_product->get_buy_price();
-                    int port_money_spent = port_increment_n
-                                           * port_product->get_buy_price();
-                    int port_money_received = ship_increment_n
-                                              * port_product->get_sell_price();
-
-                    SHIP_MONEY_P->value += ship_money_received - ship_money_spent;
-                    PORT_MONEY_P->value += port_money_received - port_money_spent;
-
-                    ship_product->n_units += ship_increment_n - port_increment_n;
-                    port_product->n_units += port_increment_n - ship_increment_n;
-                }
-
-                text = ship_product->get_name();
-                draw_text_in_rect(cell_rect, text, font_size, text_color);
-                break;
-            }
-            case 3: {  // ship buy price (port sell price)
-                int port_sell_price = port_product->get_sell_price();
-                text = std::to_string(port_sell_price);
-                draw_text_in_rect(cell_rect, text, font_size, text_color);
-                break;
-            }
-            case 4: {  // port amount
-                text = std::to_string(port_product->n_units);
-                draw_text_in_rect(cell_rect, text, font_size, text_color);
-                break;
-            }
+    if (SELECTED_PRODUCT_IDX == row_idx) {
+        int speed;
+        if (IsKeyDown(KEY_LEFT_CONTROL)) {
+            speed = 10;
+        } else if (IsKeyDown(KEY_LEFT_SHIFT)) {
+            speed = port_n_units + ship_n_units;
+        } else {
+            speed = 1;
         }
-    }
-}
-
-void draw_rows(Rectangle rect) {
-    static const int n_rows = cargo::N_PRODUCTS;
 
-    float row_height = (rect.height - BORDER * (n_rows - 1)) / n_rows;
+        // buy
+        int ship_increment_n = ui::increment_button_sprite(
+            ui::SpriteName::LEFT_ARROW_ICON, LAYOUT.buy_buttons[row_idx], speed
+        );
+        ship_increment_n = std::min(
+            ship_increment_n,
+            trade::get_max_n_buy(*SHIP_CARGO_P, *SHIP_MONEY_P, *PORT_P, product_id)
+        );
+        trade::execute_trade(
+            *SHIP_CARGO_P,
+            *SHIP_MONEY_P,
+            *PORT_P,
+            *PORT_MONEY_P,
+            product_id,
+            ship_increment_n
+        );
 
-    for (int i = 0; i < n_rows; ++i) {
-        RectangleSplit2 split = split_top_and_draw_mid(
-            rect, row_height, BORDER, ui::color::BORDER
+        // sell
+        int port_increment_n = ui::increment_button_sprite(
+            ui::SpriteName::RIGHT_ARROW_ICON, LAYOUT.sell_buttons[row_idx], speed
+        );
+        port_increment_n = std::min(
+            port_increment_n,
+            trade::get_max_n_sell(*SHIP_CARGO_P, *PORT_P, *PORT_MONEY_P, product_id)
+        );
+        trade::execute_trade(
+            *SHIP_CARGO_P,
+            *SHIP_MONEY_P,
+            *PORT_P,
+            *PORT_MONEY_P,
+            product_id,
+            -port_increment_n
         );
-        ui::radio_button_rect(split.rect0, &SELECTED_PRODUCT_IDX, i);
 
-        draw_row(split.rect0, i);
-        rect = split.rect1;
+        ship_n_units = SHIP_CARGO_P->get_n_units(product_id);
+        port_n_units = PORT_CARGO_P->get_n_units(product_id);
+    }
+
+    // ship amount, ship sell price (port buy price), product,
+    // ship buy price (port sell price), port amount
+    std::array<int, N_COLS> values = {
+        ship_n_units, port_buy_price, 0, port_sell_price, port_n_units
+    };
+
+    auto &cells = LAYOUT.cells[row_idx];
+    auto &texts = TEXTS.cells[row_idx];
+    for (int i = 0; i < N_COLS; ++i) {
+        int value = values[i];
+        auto &text = update_text(texts[i], cells[i], font_size, {value, 0}, [&] {
+            if (i == 2) return Text(cargo::get_name(product_id));
+            return Text(value);
+        });
+        draw_text(text, font_size, text_color);
+    }
+}
+
+void draw_rows() {
+    for (int i = 0; i < N_ROWS; ++i) {
+        draw_row(i);
     }
 }
 
-void draw_stats_cell(Rectangle rect, bool is_ship) {
+void draw_stats_cell(bool is_ship) {
+    auto &layout = is_ship ? LAYOUT.ship_stats : LAYOUT.port_stats;
+    auto &texts = is_ship ? TEXTS.ship_stats : TEXTS.port_stats;
     auto who = is_ship ? "Ship" : "Port";
     auto cargo = is_ship ? SHIP_CARGO_P : PORT_CARGO_P;
     auto money = is_ship ? SHIP_MONEY_P : PORT_MONEY_P;
 
-    float row_height = rect.height / 3.0;
-    DrawRectangleRec(rect, ui::color::RECT_COLD);
-
-    RectangleSplit3 split = split_top(rect, row_height, 0.0);
-    Rectangle who_rect = split.rect0;
-    rect = split.rect2;
-
-    split = split_top(rect, row_height, 0.0);
-    Rectangle cap_rect = split.rect0;
-    Rectangle gold_rect = split.rect2;
-
     // who
-    draw_text_in_rect(who_rect, who, MEDIUM_FONT_SIZE, ui::color::TEXT_LIGHT);
+    auto &who_text = update_text(
+        texts.who, layout.who_rect, MEDIUM_FONT_SIZE, {0, 0}, [&] { return Text(who); }
+    );
+    draw_text(who_text, MEDIUM_FONT_SIZE, ui::color::TEXT_LIGHT);
 
     // capacity
-    auto weight_str = std::to_string(cargo->get_weight());
-    auto capacity_str = std::to_string(cargo->capacity);
-    capacity_str = "Capacity: " + weight_str + " / " + capacity_str;
-    draw_text_in_rect(cap_rect, capacity_str, SMALL_FONT_SIZE, ui::color::TEXT_MILD);
+    int weight = cargo->get_weight();
+    int capacity = cargo->capacity;
+    auto &capacity_text = update_text(
+        texts.capacity, layout.cap_rect, SMALL_FONT_SIZE, {weight, capacity}, [&] {
+            Text text("Capacity: ");
+            text.append(weight).append(" / ").append(capacity);
+            return text;
+        }
+    );
+    draw_text(capacity_text, SMALL_FONT_SIZE, ui::color::TEXT_MILD);
 
     // money
-    auto money_str = std::to_string(money->value) + " $";
-    draw_text_in_rect(gold_rect, money_str, SMALL_FONT_SIZE, ui::color::TEXT_MILD);
+    auto &money_text = update_text(
+        texts.money, layout.gold_rect, SMALL_FONT_SIZE, {money->value, 0}, [&] {
+            Text text(money->value);
+            text.append(" $");
+            return text;
+        }
+    );
+    draw_text(money_text, SMALL_FONT_SIZE, ui::color::TEXT_MILD);
 }
 
-void draw_buttons_cell(Rectangle rect) {
-    DrawRectangleRec(rect, ui::color::RECT_COLD);
-
-    float row_height = rect.height / 2.0;
-    RectangleSplit3 split = split_top(rect, row_height, 0.0);
-
-    Rectangle summary_rect = split.rect0;
-    Rectangle buttons_rect = split.rect2;
-    buttons_rect.x += buttons_rect.width * FINAL_BUTTONS_CLOTHENESS;
-    buttons_rect.width -= buttons_rect.width * 2.0 * FINAL_BUTTONS_CLOTHENESS;
-
-    split = split_left(buttons_rect, 0.5 * buttons_rect.width, 0.0);
-    Rectangle accept_button_rect = get_middle_square(split.rect0, PAD);
-    Rectangle cancel_button_rect = get_middle_square(split.rect2, PAD);
-
+void draw_buttons_cell() {
     int money_diff = SHIP_MONEY_P->value - SHIP_MONEY_ORIG.value;
     Color money_diff_color;
-    std::string sign_str;
+    const char *sign_str;
     if (money_diff > 0) {
         money_diff_color = ui::color::TEXT_POSITIVE;
         sign_str = "+";
@@ -497,31 +710,25 @@ void draw_buttons_cell(Rectangle rect) {
         money_diff_color = ui::color::TEXT_MILD;
         sign_str = "";
     }
-    auto money_diff_str = sign_str + std::to_string(money_diff) + "$";
-    draw_text_in_rect(summary_rect, money_diff_str, LARGE_FONT_SIZE, money_diff_color);
+    auto &money_diff_text = update_text(
+        TEXTS.summary, LAYOUT.summary_rect, LARGE_FONT_SIZE, {money_diff, 0}, [&] {
+            Text text(sign_str);
+            text.append(money_diff).append("$");
+            return text;
+        }
+    );
+    draw_text(money_diff_text, LARGE_FONT_SIZE, money_diff_color);
 
-    bool is_accept = ui::button_sprite(ui::SpriteName::ACCEPT_ICON, accept_button_rect);
-    bool is_cancel = ui::button_sprite(ui::SpriteName::CANCEL_ICON, cancel_button_rect);
+    bool is_accept = ui::button_sprite(ui::SpriteName::ACCEPT_ICON, LAYOUT.accept_button);
+    bool is_cancel = ui::button_sprite(ui::SpriteName::CANCEL_ICON, LAYOUT.cancel_button);
     if (is_accept) accept_deal();
     else if (is_cancel) close_and_resed_deal();
 }
 
-void draw_footer(Rectangle rect) {
-    float full_width = rect.width;
-
-    float col_width = get_col_width(0, full_width);
-    RectangleSplit2 split = split_left_and_draw_border(rect, 2.0 * col_width + BORDER);
-    Rectangle ship_rect = split.rect0;
-    rect = split.rect1;
-
-    col_width = get_col_width(2, full_width);
-    split = split_left_and_draw_border(rect, col_width);
-    Rectangle buttons_rect = split.rect0;
-    Rectangle port_rect = split.rect1;
-
-    draw_stats_cell(ship_rect, true);
-    draw_stats_cell(port_rect, false);
-    draw_buttons_cell(buttons_rect);
+void draw_footer() {
+    draw_stats_cell(true);
+    draw_stats_cell(false);
+    draw_buttons_cell();
 }
 
 void update_and_draw() {
@@ -532,28 +739,12 @@ void update_and_draw() {
         return;
     }
 
-    int screen_width = GetScreenWidth();
-    int screen_height = GetScreenHeight();
-    Rectangle rect = {
-        .x = 0.5f * (screen_width - WINDOW_WIDTH),
-        .y = 0.5f * (screen_height - WINDOW_HEIGHT),
-        .width = WINDOW_WIDTH,
-        .height = WINDOW_HEIGHT,
-    };
-
-    RectangleSplit2 split;
-
-    rect = split_and_draw_outer_border(rect);
-    split = split_top_and_draw_mid(rect, HEADER_HEIGHT, BORDER, ui::color::BORDER);
-    Rectangle header_rect = split.rect0;
-
-    split = split_bot_and_draw_mid(split.rect1, FOOTER_HEIGHT, BORDER, ui::color::BORDER);
-    Rectangle rows_rect = split.rect0;
-    Rectangle footer_rect = split.rect1;
+    update_layout(GetScreenWidth(), GetScreenHeight());
 
-    draw_header(header_rect);
-    draw_rows(rows_rect);
-    draw_footer(footer_rect);
+    draw_backgrounds();
+    draw_header();
+    draw_rows();
+    draw_footer();
 }
 
 }  // namespace shop
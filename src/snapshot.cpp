@@ -0,0 +1,166 @@
+#include "snapshot.hpp"
+
+#include "components.hpp"
+#include "dynamic_body.hpp"
+#include "entt/entity/fwd.hpp"
+#include "entt/entt.hpp"
+#include "profiler.hpp"
+#include "registry.hpp"
+#include "ship.hpp"
+#include "trader.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace st {
+namespace snapshot {
+
+// Snapshot buffer layout, for every component storage in turn: the number
+// of elements, the packed entities, the packed components.
+class Slot {
+public:
+    uint64_t id = 0;
+    std::vector<std::byte> buffer;
+};
+
+static std::vector<Slot> SLOTS;
+static uint64_t LATEST_ID = 0;
+
+template <typename Component>
+size_t get_storage_size() {
+    size_t n = registry::registry.storage<Component>().size();
+    return sizeof(uint64_t) + n * (sizeof(entt::entity) + sizeof(Component));
+}
+
+template <typename Component>
+std::byte *write_storage(std::byte *dst) {
+    static_assert(std::is_trivially_copyable_v<Component>);
+    static const size_t page_size = entt::component_traits<Component>::page_size;
+
+    auto &storage = registry::registry.storage<Component>();
+    uint64_t n = storage.size();
+    std::memcpy(dst, &n, sizeof(n));
+    dst += sizeof(n);
+
+    std::memcpy(dst, storage.data(), n * sizeof(entt::entity));
+    dst += n * sizeof(entt::entity);
+
+    for (size_t begin = 0; begin < n; begin += page_size) {
+        size_t size = std::min(page_size, n - begin) * sizeof(Component);
+        std::memcpy(dst, storage.raw()[begin / page_size], size);
+        dst += size;
+    }
+
+    return dst;
+}
+
+// Returns nullptr if the storage doesn't hold the same entities in the same
+// order as it did in the snapshot.
+template <typename Component>
+const std::byte *check_storage(const std::byte *src) {
+    auto &storage = registry::registry.storage<Component>();
+    uint64_t n;
+    std::memcpy(&n, src, sizeof(n));
+    src += sizeof(n);
+
+    if (n != storage.size()) return nullptr;
+    if (std::memcmp(src, storage.data(), n * sizeof(entt::entity)) != 0) return nullptr;
+
+    return src + n * (sizeof(entt::entity) + sizeof(Component));
+}
+
+template <typename Component>
+const std::byte *read_storage(const std::byte *src) {
+    static const size_t page_size = entt::component_traits<Component>::page_size;
+
+    auto &storage = registry::registry.storage<Component>();
+    uint64_t n;
+    std::memcpy(&n, src, sizeof(n));
+    src += sizeof(n) + n * sizeof(entt::entity);
+
+    for (size_t begin = 0; begin < n; begin += page_size) {
+        size_t size = std::min(page_size, n - begin) * sizeof(Component);
+        std::memcpy(storage.raw()[begin / page_size], src, size);
+        src += size;
+    }
+
+    return src;
+}
+
+// The snapshotted storages, in buffer order.
+template <typename... Components>
+class Layout {
+public:
+    static size_t get_size() {
+        return (get_storage_size<Components>() + ...);
+    }
+
+    static void write(std::vector<std::byte> &buffer) {
+        // grows the buffer only if the registry got bigger
+        size_t size = get_size();
+        if (buffer.size() < size) buffer.resize(size);
+
+        std::byte *dst = buffer.data();
+        ((dst = write_storage<Components>(dst)), ...);
+    }
+
+    static bool read(const std::vector<std::byte> &buffer) {
+        // all storages are checked before any of them is touched
+        const std::byte *src = buffer.data();
+        ((src = src ? check_storage<Components>(src) : nullptr), ...);
+        if (!src) return false;
+
+        src = buffer.data();
+        ((src = read_storage<Components>(src)), ...);
+        return true;
+    }
+};
+
+using SnapshotLayout = Layout<
+    components::Transform,
+    dynamic_body::DynamicBody,
+    ship::Ship,
+    components::Port,
+    components::Money,
+    trader::Trader>;
+
+void load(int n_slots) {
+    SLOTS.clear();
+    SLOTS.resize(std::max(n_slots, 1));
+    LATEST_ID = 0;
+
+    size_t size = SnapshotLayout::get_size();
+    for (auto &slot : SLOTS) slot.buffer.resize(size);
+}
+
+uint64_t take() {
+    profiler::push("snapshot::take");
+    Slot &slot = SLOTS[LATEST_ID % SLOTS.size()];
+    slot.id = ++LATEST_ID;
+    SnapshotLayout::write(slot.buffer);
+    profiler::pop();
+
+    return slot.id;
+}
+
+bool restore(uint64_t id) {
+    if (id == 0 || SLOTS.empty()) return false;
+    Slot &slot = SLOTS[(id - 1) % SLOTS.size()];
+    if (slot.id != id) return false;
+
+    profiler::push("snapshot::restore");
+    bool is_restored = SnapshotLayout::read(slot.buffer);
+    profiler::pop();
+
+    return is_restored;
+}
+
+uint64_t get_latest_id() {
+    return LATEST_ID;
+}
+
+}  // namespace snapshot
+}  // namespace st
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+namespace st {
+namespace snapshot {
+
+// Allocates a ring of n_slots snapshot buffers, sized for the registry as it
+// is (call it after the world is spawned). Taking a snapshot when the ring is
+// full overwrites the oldest one.
+void load(int n_slots);
+
+// Copies the Transform, DynamicBody, Ship, Port, Money and Trader storages
+// into the next ring buffer and returns the snapshot id. Components are
+// copied page by page, they're all trivially copyable.
+uint64_t take();
+
+// Copies the snapshot's components back into the registry. Only the
+// component values are restored: it fails (returns false) if the snapshot
+// is overwritten or some of the storages have been added to, removed from
+// or reordered since. Module state outside of the registry (economy, order
+// books, ...) isn't part of the snapshot.
+bool restore(uint64_t id);
+
+// Id of the latest snapshot, 0 if none was taken.
+uint64_t get_latest_id();
+
+}  // namespace snapshot
+}  // namespace st
@@ -0,0 +1,164 @@
+#include "spawn.hpp"
+
+#include "behaviour.hpp"
+#include "cargo.hpp"
+#include "components.hpp"
+#include "dynamic_body.hpp"
+#include "entt/entity/fwd.hpp"
+#include "entt/entt.hpp"
+#include "registry.hpp"
+#include "ship.hpp"
+#include "terrain.hpp"
+#include "trader.hpp"
+
+namespace st {
+namespace spawn {
+
+cargo::Cargo get_ship_cargo() {
+    cargo::Cargo cargo(1000);
+    cargo.add_units(cargo::ProductID::PROVISION_ID, 30);
+    cargo.add_units(cargo::ProductID::RUM_ID, 10);
+    cargo.add_units(cargo::ProductID::WOOD_ID, 5);
+    return cargo;
+}
+
+cargo::Cargo get_port_cargo() {
+    cargo::Cargo cargo(1000000);
+    cargo.add_units(cargo::ProductID::PROVISION_ID, 1000);
+    cargo.add_units(cargo::ProductID::RUM_ID, 1000);
+    cargo.add_units(cargo::ProductID::WOOD_ID, 500);
+    cargo.add_units(cargo::ProductID::SILVER_ID, 50);
+    cargo.add_units(cargo::ProductID::GOLD_ID, 25);
+    return cargo;
+}
+
+void emplace_ship(
+    entt::entity entity,
+    Vector2 position,
+    ship::ControllerType controller_type,
+    const cargo::Cargo &cargo
+) {
+    auto &registry = registry::registry;
+
+    // Ship goes last: it completes the owning ships group, so the entity is
+    // moved into the group range only once
+    registry.emplace<components::Transform>(entity, position, 0.0);
+    registry.emplace<dynamic_body::DynamicBody>(entity, 1000.0, 1000.0, 1.0, 10.0);
+    registry.emplace<components::Money>(entity, 1000);
+    registry.emplace<ship::Ship>(entity, controller_type, cargo);
+}
+
+void emplace_port(entt::entity entity, Vector2 position, const cargo::Cargo &cargo) {
+    auto &registry = registry::registry;
+
+    registry.emplace<components::Transform>(entity, position, 0.0);
+    registry.emplace<components::Money>(entity, 500000);
+    Vector2 dock_position = terrain::get_nearest_water(position);
+    registry.emplace<components::Port>(entity, 3.0, dock_position, cargo);
+}
+
+template <typename... Components>
+void reserve(int n) {
+    (registry::registry.storage<Components>().reserve(
+         registry::registry.storage<Components>().size() + n
+     ),
+     ...);
+}
+
+entt::entity create_ship(Vector2 position, ship::ControllerType controller_type) {
+    auto entity = registry::registry.create();
+    emplace_ship(entity, position, controller_type, get_ship_cargo());
+
+    return entity;
+}
+
+entt::entity create_player(Vector2 position) {
+    auto entity = create_ship(position, ship::ControllerType::MANUAL);
+    registry::registry.emplace<components::Player>(entity);
+
+    return entity;
+}
+
+entt::entity create_port(Vector2 position) {
+    auto entity = registry::registry.create();
+    emplace_port(entity, position, get_port_cargo());
+
+    return entity;
+}
+
+std::vector<entt::entity> create_ships(
+    const std::vector<Vector2> &positions, ship::ControllerType controller_type
+) {
+    using components::Money;
+    using components::Transform;
+    using dynamic_body::DynamicBody;
+    using ship::Ship;
+
+    int n = positions.size();
+    reserve<Transform, DynamicBody, Ship, Money>(n);
+
+    std::vector<entt::entity> entities(n);
+    registry::registry.create(entities.begin(), entities.end());
+
+    auto cargo = get_ship_cargo();
+    for (int i = 0; i < n; ++i) {
+        emplace_ship(entities[i], positions[i], controller_type, cargo);
+    }
+
+    return entities;
+}
+
+std::vector<entt::entity> create_ports(const std::vector<Vector2> &positions) {
+    int n = positions.size();
+    reserve<components::Transform, components::Port, components::Money>(n);
+
+    std::vector<entt::entity> entities(n);
+    registry::registry.create(entities.begin(), entities.end());
+
+    auto cargo = get_port_cargo();
+    for (int i = 0; i < n; ++i) {
+        emplace_port(entities[i], positions[i], cargo);
+    }
+
+    return entities;
+}
+
+std::vector<entt::entity> create_traders(const std::vector<int> &port_idxs) {
+    auto ports = registry::get_ports_group().storage<components::Port>()->rbegin();
+
+    int n = port_idxs.size();
+    std::vector<Vector2> positions(n);
+    for (int i = 0; i < n; ++i) {
+        positions[i] = ports[port_idxs[i]].dock_position;
+    }
+
+    auto entities = create_ships(positions, ship::ControllerType::TRADER);
+    reserve<trader::Trader>(n);
+    for (int i = 0; i < n; ++i) {
+        registry::registry.get<ship::Ship>(entities[i]).target_position = positions[i];
+        registry::registry.emplace<trader::Trader>(entities[i], port_idxs[i]);
+    }
+
+    return entities;
+}
+
+std::vector<entt::entity> create_ferries(const std::vector<int> &port_idxs) {
+    auto ports = registry::get_ports_group().storage<components::Port>()->rbegin();
+
+    int n = port_idxs.size();
+    std::vector<Vector2> positions(n);
+    for (int i = 0; i < n; ++i) {
+        positions[i] = ports[port_idxs[i]].dock_position;
+    }
+
+    auto entities = create_ships(positions, ship::ControllerType::FERRY);
+    for (int i = 0; i < n; ++i) {
+        registry::registry.get<ship::Ship>(entities[i]).target_position = positions[i];
+        behaviour::start(behaviour::ferry(entities[i], port_idxs[i]));
+    }
+
+    return entities;
+}
+
+}  // namespace spawn
+}  // namespace st
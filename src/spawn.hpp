@@ -0,0 +1,31 @@
+#pragma once
+
+#include "entt/entity/fwd.hpp"
+#include "entt/entt.hpp"
+#include "raylib/raylib.h"
+#include "ship.hpp"
+#include <vector>
+
+namespace st {
+namespace spawn {
+
+entt::entity create_ship(Vector2 position, ship::ControllerType controller_type);
+entt::entity create_player(Vector2 position);
+entt::entity create_port(Vector2 position);
+
+// Batch versions: entities are created in one go, component storages are
+// reserved up front and every component is constructed in place.
+std::vector<entt::entity> create_ships(
+    const std::vector<Vector2> &positions, ship::ControllerType controller_type
+);
+std::vector<entt::entity> create_ports(const std::vector<Vector2> &positions);
+
+// NPC traders docked at the given ports (indices in the ports group).
+std::vector<entt::entity> create_traders(const std::vector<int> &port_idxs);
+
+// NPC ferries docked at the given ports, each driven by a behaviour::ferry
+// task.
+std::vector<entt::entity> create_ferries(const std::vector<int> &port_idxs);
+
+}  // namespace spawn
+}  // namespace st
@@ -1,6 +1,7 @@
 #include "terrain.hpp"
 
 #include "constants.hpp"
+#include "jobs.hpp"
 #include "raylib/raylib.h"
 #include "renderer.hpp"
 #include "resources.hpp"
@@ -28,14 +29,22 @@ static constexpr float RESOLUTION = 4.0;
 static constexpr float WATER_LEVEL = 0.6;
 static constexpr int DATA_SIZE = WORLD_SIZE * RESOLUTION;
 
-// data pointers
-static float *HEIGHTS;
-static float *DISTS_TO_WATER;
-static float *DISTS_TO_GROUND;
+// data pointers: either generated by load, or owned by the caller of load
+// (e.g. mapped from a save file)
+static const float *HEIGHTS;
+static const float *DISTS_TO_WATER;
+static const float *DISTS_TO_GROUND;
+// generated grids are freed by unload_data, the given ones belong to the caller
+static bool IS_DATA_OWNED = false;
 static Texture HEIGHTS_TEXTURE;
 
 // pathfinding parameters
 static constexpr int PATH_STEP = 3;
+// min distance (in cells) from the path to the ground
+static constexpr int PATH_CLEARANCE = 3;
+
+// how many cells off the coast get_nearest_water goes
+static constexpr int OFFSHORE_N_STEPS = 4;
 
 std::pair<int, int> data_idx_to_xy(int idx) {
     int x = idx % DATA_SIZE;
@@ -113,51 +122,97 @@ void load() {
     float gain = 1.0;
     int octaves = 8;
 
-    HEIGHTS = (float *)malloc(DATA_SIZE * DATA_SIZE * sizeof(float));
+    float *heights = (float *)malloc(DATA_SIZE * DATA_SIZE * sizeof(float));
+
+    jobs::parallel_for(0, DATA_SIZE * DATA_SIZE, DATA_SIZE, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            auto [x, y] = data_idx_to_xy(i);
+
+            float nx = (float)(x + offset_x) * (scale / (float)DATA_SIZE);
+            float ny = (float)(y + offset_y) * (scale / (float)DATA_SIZE);
+            heights[i] = stb_perlin_fbm_noise3(nx, ny, 0.0, lacunarity, gain, octaves);
+        }
+    });
 
     float max_height = -FLT_MAX;
     float min_height = FLT_MAX;
     for (int i = 0; i < DATA_SIZE * DATA_SIZE; ++i) {
-        auto [x, y] = data_idx_to_xy(i);
-
-        float nx = (float)(x + offset_x) * (scale / (float)DATA_SIZE);
-        float ny = (float)(y + offset_y) * (scale / (float)DATA_SIZE);
-        float height = stb_perlin_fbm_noise3(nx, ny, 0.0, lacunarity, gain, octaves);
-
-        max_height = std::max(max_height, height);
-        min_height = std::min(min_height, height);
-        HEIGHTS[i] = height;
+        max_height = std::max(max_height, heights[i]);
+        min_height = std::min(min_height, heights[i]);
     }
 
     for (int i = 0; i < DATA_SIZE * DATA_SIZE; ++i) {
-        float *height = &HEIGHTS[i];
+        float *height = &heights[i];
         *height = (*height - min_height) / (max_height - min_height);
     }
+    HEIGHTS = heights;
 
     // -------------------------------------------------------------------
-    // init heights_texture
+    // init distances
+    auto handle = jobs::submit([] { DISTS_TO_WATER = get_distances(check_if_water); });
+    DISTS_TO_GROUND = get_distances(check_if_ground);
+    jobs::wait(handle);
+    IS_DATA_OWNED = true;
+}
+
+void load(
+    const float *heights, const float *dists_to_water, const float *dists_to_ground
+) {
+    HEIGHTS_TEXTURE.id = 0;
+    HEIGHTS = heights;
+    DISTS_TO_WATER = dists_to_water;
+    DISTS_TO_GROUND = dists_to_ground;
+    IS_DATA_OWNED = false;
+}
+
+void load_texture() {
     Image image;
-    image.data = HEIGHTS;
+    // raylib only reads the image data here
+    image.data = (void *)HEIGHTS;
     image.width = DATA_SIZE;
     image.height = DATA_SIZE;
     image.mipmaps = 1;
     image.format = PIXELFORMAT_UNCOMPRESSED_R32;
     HEIGHTS_TEXTURE = LoadTextureFromImage(image);
-
-    // -------------------------------------------------------------------
-    // init distances
-    DISTS_TO_WATER = get_distances(check_if_water);
-    DISTS_TO_GROUND = get_distances(check_if_ground);
 }
 
 void unload() {
-    UnloadTexture(HEIGHTS_TEXTURE);
+    if (HEIGHTS_TEXTURE.id != 0) UnloadTexture(HEIGHTS_TEXTURE);
+}
+
+void unload_data() {
+    if (IS_DATA_OWNED) {
+        free((void *)HEIGHTS);
+        free((void *)DISTS_TO_WATER);
+        free((void *)DISTS_TO_GROUND);
+    }
+
+    HEIGHTS = nullptr;
+    DISTS_TO_WATER = nullptr;
+    DISTS_TO_GROUND = nullptr;
+    IS_DATA_OWNED = false;
 }
 
 int get_world_size() {
     return WORLD_SIZE;
 }
 
+int get_data_size() {
+    return DATA_SIZE;
+}
+
+const float *get_heights() {
+    return HEIGHTS;
+}
+
+const float *get_dists_to_water() {
+    return DISTS_TO_WATER;
+}
+
+const float *get_dists_to_ground() {
+    return DISTS_TO_GROUND;
+}
+
 Vector2 get_world_center() {
     return {WORLD_SIZE / 2.0f, WORLD_SIZE / 2.0f};
 }
@@ -183,6 +238,41 @@ float get_dist_to_water(Vector2 pos) {
     return DISTS_TO_WATER[idx];
 }
 
+// Neighbor of the cell with the lowest (or highest) value in the field.
+int get_extreme_neighbor_idx(int idx, const float *field, bool is_max) {
+    auto [x, y] = data_idx_to_xy(idx);
+    int best_idx = idx;
+    for (auto [dx, dy] : DIRECTIONS) {
+        int neighbor_idx = xy_to_data_idx(x + dx, y + dy);
+        if (neighbor_idx < 0) continue;
+
+        float value = field[neighbor_idx];
+        float best_value = field[best_idx];
+        if (is_max ? value > best_value : value < best_value) best_idx = neighbor_idx;
+    }
+
+    return best_idx;
+}
+
+Vector2 get_nearest_water(Vector2 pos) {
+    int idx = world_to_data_idx(pos);
+    if (idx < 0) return pos;
+
+    // down the distance field to the coast
+    while (DISTS_TO_WATER[idx] > 0.0) {
+        int next_idx = get_extreme_neighbor_idx(idx, DISTS_TO_WATER, false);
+        if (next_idx == idx) break;
+        idx = next_idx;
+    }
+
+    // and a bit off the coast
+    for (int i = 0; i < OFFSHORE_N_STEPS; ++i) {
+        idx = get_extreme_neighbor_idx(idx, DISTS_TO_GROUND, true);
+    }
+
+    return data_idx_to_world(idx);
+}
+
 bool check_if_water(float h) {
     return h <= WATER_LEVEL;
 }
@@ -231,9 +321,34 @@ float get_h_cost(int idx1, int idx2) {
     return h_cost;
 }
 
+// Checks every cell a path step passes, so paths don't jump over thin land
+// or cut diagonally between two land cells. The cells also have to be at
+// least clearance cells away from the ground.
+bool check_if_segment_water(
+    int x, int y, std::pair<int, int> dir, int step, float clearance
+) {
+    auto [dx, dy] = dir;
+    for (int k = 1; k <= step; ++k) {
+        int idx = xy_to_data_idx(x + dx * k, y + dy * k);
+        if (idx < 0 || !check_if_water(HEIGHTS[idx])) return false;
+        if (DISTS_TO_GROUND[idx] < clearance) return false;
+        if (dx == 0 || dy == 0) continue;
+
+        int side_idx0 = xy_to_data_idx(x + dx * k, y + dy * (k - 1));
+        int side_idx1 = xy_to_data_idx(x + dx * (k - 1), y + dy * k);
+        if (!check_if_water(HEIGHTS[side_idx0]) || !check_if_water(HEIGHTS[side_idx1])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 std::vector<Vector2> get_path(Vector2 start, Vector2 end) {
-    static std::array<Node, DATA_SIZE * DATA_SIZE> nodes;
-    std::memset(nodes.data(), 0, sizeof(nodes));
+    // every thread searches in its own node grid
+    static thread_local std::vector<Node> nodes;
+    nodes.resize(DATA_SIZE * DATA_SIZE);
+    std::memset(nodes.data(), 0, nodes.size() * sizeof(Node));
 
     std::priority_queue<Node, std::vector<Node>, CompareNode> queue;
     std::vector<Vector2> path = {};
@@ -241,6 +356,7 @@ std::vector<Vector2> get_path(Vector2 start, Vector2 end) {
     int start_idx = world_to_data_idx(start);
     int end_idx = world_to_data_idx(end);
     if (start_idx < 0 || end_idx < 0) return path;
+    auto [start_x, start_y] = data_idx_to_xy(start_idx);
     auto [end_x, end_y] = data_idx_to_xy(end_idx);
 
     Node start_node = {start_idx, -1, 0, get_h_cost(start_idx, end_idx)};
@@ -271,7 +387,17 @@ std::vector<Vector2> get_path(Vector2 start, Vector2 end) {
             int new_x = current_x + dir.first * step;
             int new_y = current_y + dir.second * step;
             int new_idx = xy_to_data_idx(new_x, new_y);
-            if (new_idx < 0 || !check_if_water(HEIGHTS[new_idx])) continue;
+            if (new_idx < 0) continue;
+
+            // the clearance is waived around the path ends, which can be
+            // close to the coast
+            int start_d = std::max(std::abs(new_x - start_x), std::abs(new_y - start_y));
+            int end_d = std::max(std::abs(new_x - end_x), std::abs(new_y - end_y));
+            bool is_near_ends = std::min(start_d, end_d) <= PATH_CLEARANCE + PATH_STEP;
+            float clearance = is_near_ends ? 0.0 : PATH_CLEARANCE;
+            if (!check_if_segment_water(current_x, current_y, dir, step, clearance)) {
+                continue;
+            }
 
             float d_cost = (dir.first == 0 || dir.second == 0) ? step : step * SQRT2;
             float g_cost = current.g_cost + d_cost;
@@ -288,6 +414,19 @@ std::vector<Vector2> get_path(Vector2 start, Vector2 end) {
     return path;
 }
 
+std::vector<std::vector<Vector2>> get_paths(
+    const std::vector<Vector2> &starts, const std::vector<Vector2> &ends
+) {
+    std::vector<std::vector<Vector2>> paths(starts.size());
+    jobs::parallel_for(0, starts.size(), 1, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            paths[i] = get_path(starts[i], ends[i]);
+        }
+    });
+
+    return paths;
+}
+
 // -----------------------------------------------------------------------
 // draw
 void draw() {
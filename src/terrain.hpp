@@ -7,14 +7,33 @@ namespace st {
 namespace terrain {
 
 void load();
+// Uses the given grids (DATA_SIZE x DATA_SIZE, e.g. mapped from a save file)
+// in place instead of generating them. They must outlive the terrain.
+void load(
+    const float *heights, const float *dists_to_water, const float *dists_to_ground
+);
+void load_texture();
 void unload();
+// Forgets the grids and frees them if they were generated. Call it before the
+// memory given to load is released.
+void unload_data();
 
 int get_world_size();
+// Side of the data grids, in cells.
+int get_data_size();
+const float *get_heights();
+const float *get_dists_to_water();
+const float *get_dists_to_ground();
 Vector2 get_world_center();
 Rectangle get_world_rect();
 float get_height(Vector2 pos);
 float get_dist_to_water(Vector2 pos);
+// Water position close to the coast nearest to pos (e.g. a port's dock).
+Vector2 get_nearest_water(Vector2 pos);
 std::vector<Vector2> get_path(Vector2 start, Vector2 end);
+std::vector<std::vector<Vector2>> get_paths(
+    const std::vector<Vector2> &starts, const std::vector<Vector2> &ends
+);
 
 bool check_if_water(float h);
 bool check_if_water(Vector2 pos);
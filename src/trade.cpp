@@ -0,0 +1,130 @@
+#include "trade.hpp"
+
+#include "cargo.hpp"
+#include "components.hpp"
+#include "registry.hpp"
+#include "ship.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace st {
+namespace trade {
+
+int get_max_n_transfer(
+    const cargo::Cargo &seller_cargo,
+    const cargo::Cargo &buyer_cargo,
+    const components::Money &buyer_money,
+    cargo::ProductID product_id,
+    int price
+) {
+    int n_units = seller_cargo.get_n_units(product_id);
+    int unit_weight = cargo::get_product(product_id).unit_weight;
+
+    n_units = std::min(n_units, buyer_cargo.get_free_weight() / unit_weight);
+    if (price > 0) n_units = std::min(n_units, buyer_money.value / price);
+
+    return std::max(n_units, 0);
+}
+
+Status check_transfer(
+    const cargo::Cargo &seller_cargo,
+    const cargo::Cargo &buyer_cargo,
+    const components::Money &buyer_money,
+    cargo::ProductID product_id,
+    int n_units,
+    int price
+) {
+    int unit_weight = cargo::get_product(product_id).unit_weight;
+
+    if (seller_cargo.get_n_units(product_id) < n_units) {
+        return Status::NOT_ENOUGH_UNITS;
+    }
+    if (buyer_cargo.get_free_weight() < n_units * unit_weight) {
+        return Status::NOT_ENOUGH_CAPACITY;
+    }
+    if (buyer_money.value < n_units * price) {
+        return Status::NOT_ENOUGH_MONEY;
+    }
+
+    return Status::OK;
+}
+
+int get_max_n_buy(
+    const cargo::Cargo &ship_cargo,
+    const components::Money &ship_money,
+    const components::Port &port,
+    cargo::ProductID product_id
+) {
+    int price = port.prices.get_sell_price(product_id);
+    return get_max_n_transfer(port.cargo, ship_cargo, ship_money, product_id, price);
+}
+
+int get_max_n_sell(
+    const cargo::Cargo &ship_cargo,
+    const components::Port &port,
+    const components::Money &port_money,
+    cargo::ProductID product_id
+) {
+    int price = port.prices.get_buy_price(product_id);
+    return get_max_n_transfer(ship_cargo, port.cargo, port_money, product_id, price);
+}
+
+Status execute_trade(
+    cargo::Cargo &ship_cargo,
+    components::Money &ship_money,
+    components::Port &port,
+    components::Money &port_money,
+    cargo::ProductID product_id,
+    int n_units
+) {
+    if (n_units == 0) return Status::OK;
+
+    bool is_buy = n_units > 0;
+    int n = is_buy ? n_units : -n_units;
+    int price = is_buy ? port.prices.get_sell_price(product_id)
+                       : port.prices.get_buy_price(product_id);
+
+    Status status;
+    if (is_buy) {
+        status = check_transfer(port.cargo, ship_cargo, ship_money, product_id, n, price);
+    } else {
+        status = check_transfer(ship_cargo, port.cargo, port_money, product_id, n, price);
+    }
+    if (status != Status::OK) return status;
+
+    int money = n_units * price;
+    ship_money.value -= money;
+    port_money.value += money;
+    ship_cargo.add_units(product_id, n_units);
+    port.cargo.remove_units(product_id, n_units);
+
+    return Status::OK;
+}
+
+Status execute_trade(
+    entt::entity ship_entity,
+    entt::entity port_entity,
+    cargo::ProductID product_id,
+    int n_units
+) {
+    auto &ship_cargo = registry::registry.get<ship::Ship>(ship_entity).cargo;
+    auto &ship_money = registry::registry.get<components::Money>(ship_entity);
+    auto &port = registry::registry.get<components::Port>(port_entity);
+    auto &port_money = registry::registry.get<components::Money>(port_entity);
+
+    return execute_trade(ship_cargo, ship_money, port, port_money, product_id, n_units);
+}
+
+void execute_trades(const std::vector<Order> &orders, std::vector<Status> &statuses) {
+    statuses.resize(orders.size());
+
+    for (size_t i = 0; i < orders.size(); ++i) {
+        const Order &order = orders[i];
+        statuses[i] = execute_trade(
+            order.ship_entity, order.port_entity, order.product_id, order.n_units
+        );
+    }
+}
+
+}  // namespace trade
+}  // namespace st
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "cargo.hpp"
+#include "components.hpp"
+#include "entt/entity/fwd.hpp"
+#include <vector>
+
+namespace st {
+namespace trade {
+
+enum class Status {
+    OK,
+    NOT_ENOUGH_UNITS,
+    NOT_ENOUGH_CAPACITY,
+    NOT_ENOUGH_MONEY,
+};
+
+// A request to move units of a product between a ship and a port.
+// Positive n_units means the ship buys from the port, negative - sells to it.
+class Order {
+public:
+    entt::entity ship_entity;
+    entt::entity port_entity;
+    cargo::ProductID product_id;
+    int n_units;
+};
+
+// Max number of units the ship can buy from (or sell to) the port right now,
+// limited by the seller's stock, the buyer's free weight and money.
+int get_max_n_buy(
+    const cargo::Cargo &ship_cargo,
+    const components::Money &ship_money,
+    const components::Port &port,
+    cargo::ProductID product_id
+);
+int get_max_n_sell(
+    const cargo::Cargo &ship_cargo,
+    const components::Port &port,
+    const components::Money &port_money,
+    cargo::ProductID product_id
+);
+
+// Validates the whole trade first and applies it only if it's valid, so
+// either both sides are updated or nothing is changed.
+Status execute_trade(
+    cargo::Cargo &ship_cargo,
+    components::Money &ship_money,
+    components::Port &port,
+    components::Money &port_money,
+    cargo::ProductID product_id,
+    int n_units
+);
+Status execute_trade(
+    entt::entity ship_entity,
+    entt::entity port_entity,
+    cargo::ProductID product_id,
+    int n_units
+);
+
+// Executes orders in the given order, so later orders see the effects of
+// the earlier ones. statuses[i] is the outcome of orders[i].
+void execute_trades(const std::vector<Order> &orders, std::vector<Status> &statuses);
+
+}  // namespace trade
+}  // namespace st
@@ -0,0 +1,309 @@
+#include "trader.hpp"
+
+#include "cargo.hpp"
+#include "components.hpp"
+#include "dynamic_body.hpp"
+#include "entt/entity/fwd.hpp"
+#include "entt/entt.hpp"
+#include "jobs.hpp"
+#include "knapsack.hpp"
+#include "order_book.hpp"
+#include "port_index.hpp"
+#include "port_zones.hpp"
+#include "price_history.hpp"
+#include "profiler.hpp"
+#include "raylib/raylib.h"
+#include "raylib/raymath.h"
+#include "registry.hpp"
+#include "routes.hpp"
+#include "ship.hpp"
+#include "trade.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+
+namespace st {
+namespace trader {
+
+// the ship heads for the next waypoint once it's this close to the current
+static const float WAYPOINT_RADIUS = 0.75;
+
+// a ship which can't move for this many ticks (it's pushing against the
+// coast) heads back to the previous waypoint and retries from there
+static const int N_BLOCKED_TICKS_TO_BACK_OFF = 90;
+
+// planning budget per tick, and how many best destinations are evaluated
+static const int MAX_N_PLANS_PER_TICK = 16;
+static const int N_CANDIDATE_DESTS = 3;
+
+// without a profitable route the trader moves to one of the nearest ports;
+// if none of them is reachable it retries after the next price update
+static const int N_RELOCATION_CANDIDATES = 8;
+static const int N_TICKS_TO_REPLAN = 60;
+
+static const int TRADERS_GRAIN_SIZE = 1024;
+
+// first trader of the next tick's planning round
+static int PLAN_CURSOR = 0;
+
+Trader::Trader(int port_idx)
+    : port_idx(port_idx)
+    , dest_port_idx(port_idx) {}
+
+void sail(
+    Trader &trader,
+    ship::Ship &ship,
+    const components::Transform &transform,
+    const dynamic_body::DynamicBody &body
+) {
+    auto &path = routes::get_path(trader.port_idx, trader.dest_port_idx);
+
+    bool is_blocked = body.linear_velocity.x == 0.0 && body.linear_velocity.y == 0.0;
+    trader.n_wait_ticks = is_blocked ? trader.n_wait_ticks + 1 : 0;
+    if (trader.n_wait_ticks >= N_BLOCKED_TICKS_TO_BACK_OFF) {
+        trader.n_wait_ticks = 0;
+        if (trader.waypoint_idx > 0) {
+            trader.waypoint_idx -= 1;
+            ship.target_position = path[trader.waypoint_idx];
+            return;
+        }
+    }
+
+    while (trader.waypoint_idx < path.size()) {
+        Vector2 waypoint = path[trader.waypoint_idx];
+        if (Vector2Distance(transform.position, waypoint) > WAYPOINT_RADIUS) break;
+        trader.waypoint_idx += 1;
+    }
+
+    if (trader.waypoint_idx >= path.size()) {
+        trader.port_idx = trader.dest_port_idx;
+        trader.state = State::TRADING;
+    } else {
+        ship.target_position = path[trader.waypoint_idx];
+    }
+}
+
+// Asks for the best bid in the book for all of the cargo. Returns the number
+// of orders posted.
+int post_cargo(entt::entity entity, const ship::Ship &ship, entt::entity port_entity) {
+    int n_orders = 0;
+    for (int p = 0; p < cargo::N_PRODUCTS; ++p) {
+        auto product_id = (cargo::ProductID)p;
+        int n_units = ship.cargo.get_n_units(product_id);
+        int price = order_book::get_best_bid(port_entity, product_id);
+        if (n_units == 0 || price == 0) continue;
+
+        order_book::submit_order(
+            entity,
+            port_entity,
+            product_id,
+            order_book::Side::ASK,
+            price,
+            n_units,
+            order_book::TimeInForce::NEXT_MATCH
+        );
+        n_orders += 1;
+    }
+
+    return n_orders;
+}
+
+// Random reachable port among the nearest ones, -1 if there is none.
+int get_relocation_port_idx(int port_idx) {
+    auto port_entity = registry::get_port_entity(port_idx);
+    auto &transform = registry::registry.get<components::Transform>(port_entity);
+    std::array<int, N_RELOCATION_CANDIDATES + 1> port_idxs;
+    int n_port_idxs = port_index::find_nearest(
+        transform.position, port_idxs.size(), port_idxs.data()
+    );
+
+    // the nearest one is the trader's own port, the rest is tried starting
+    // from a random one
+    int n_candidates = n_port_idxs - 1;
+    int offset = n_candidates > 0 ? std::rand() % n_candidates : 0;
+    for (int i = 0; i < n_candidates; ++i) {
+        int dest_port_idx = port_idxs[1 + (offset + i) % n_candidates];
+        if (!routes::get_path(port_idx, dest_port_idx).empty()) return dest_port_idx;
+    }
+
+    return -1;
+}
+
+// Price trend at the port of the cargo to carry there, weighted by units:
+// above 1 if what the trader would sell there is getting more expensive.
+float get_cargo_trend(
+    const knapsack::Solution<cargo::N_PRODUCTS> &solution, int port_idx
+) {
+    float trend = 0.0;
+    int n_units = 0;
+    for (int p = 0; p < cargo::N_PRODUCTS; ++p) {
+        auto product_id = (cargo::ProductID)p;
+        trend += solution.n_units[p] * price_history::get_trend(port_idx, product_id);
+        n_units += solution.n_units[p];
+    }
+
+    return n_units > 0 ? trend / n_units : 1.0;
+}
+
+// Picks the destination with the most profit per sea distance, adjusted by
+// the price trend there, among the best routes from the port, and bids for
+// the cargo for it at the best ask. Without a profitable route the trader
+// relocates to a random port nearby.
+void plan(
+    Trader &trader,
+    entt::entity entity,
+    ship::Ship &ship,
+    components::Money &money,
+    components::Port &port
+) {
+    auto ports = registry::get_ports_group().storage<components::Port>()->rbegin();
+
+    std::array<int, N_CANDIDATE_DESTS> dest_port_idxs;
+    int n_dests = 0;
+    for (auto &route : routes::get_best_routes(trader.port_idx)) {
+        if (n_dests == N_CANDIDATE_DESTS) break;
+
+        auto end = dest_port_idxs.begin() + n_dests;
+        if (std::find(dest_port_idxs.begin(), end, route.to_port_idx) != end) continue;
+        dest_port_idxs[n_dests++] = route.to_port_idx;
+    }
+
+    int best_dest_port_idx = -1;
+    float best_score = 0.0;
+    knapsack::Solution<cargo::N_PRODUCTS> best_cargo;
+    for (int i = 0; i < n_dests; ++i) {
+        int dest_port_idx = dest_port_idxs[i];
+        auto solution = knapsack::get_best_cargo(
+            ship.cargo, money.value, port, ports[dest_port_idx]
+        );
+
+        float distance = routes::get_distance(trader.port_idx, dest_port_idx);
+        float trend = get_cargo_trend(solution, dest_port_idx);
+        float score = solution.profit * trend / distance;
+        if (score > best_score) {
+            best_score = score;
+            best_dest_port_idx = dest_port_idx;
+            best_cargo = solution;
+        }
+    }
+
+    if (best_dest_port_idx == -1) {
+        best_dest_port_idx = get_relocation_port_idx(trader.port_idx);
+    }
+    if (best_dest_port_idx == -1) {
+        trader.n_wait_ticks = N_TICKS_TO_REPLAN;
+        return;
+    }
+
+    auto port_entity = registry::get_port_entity(trader.port_idx);
+    int n_orders = 0;
+    for (int p = 0; p < cargo::N_PRODUCTS; ++p) {
+        auto product_id = (cargo::ProductID)p;
+        int n_units = std::min(
+            best_cargo.n_units[p],
+            trade::get_max_n_buy(ship.cargo, money, port, product_id)
+        );
+        int price = order_book::get_best_ask(port_entity, product_id);
+        if (n_units <= 0 || price == 0) continue;
+
+        order_book::submit_order(
+            entity,
+            port_entity,
+            product_id,
+            order_book::Side::BID,
+            price,
+            n_units,
+            order_book::TimeInForce::NEXT_MATCH
+        );
+        n_orders += 1;
+    }
+
+    trader.dest_port_idx = best_dest_port_idx;
+    trader.waypoint_idx = 0;
+    trader.n_wait_ticks = 0;
+    trader.state = n_orders > 0 ? State::BUYING : State::SAILING;
+}
+
+void on_port_zone_event(const port_zones::Event &event) {
+    if (event.type != port_zones::EventType::ENTER) return;
+
+    auto trader = registry::registry.try_get<Trader>(event.ship_entity);
+    if (!trader || trader->state != State::SAILING) return;
+    if (event.port_idx != trader->dest_port_idx) return;
+
+    trader->port_idx = trader->dest_port_idx;
+    trader->state = State::TRADING;
+}
+
+void load() {
+    port_zones::subscribe(on_port_zone_event);
+}
+
+void update() {
+    auto &storage = registry::registry.storage<Trader>();
+    auto entities = storage.data();
+    auto traders = storage.rbegin();
+    int n_traders = storage.size();
+    if (n_traders == 0) return;
+
+    // sailing touches only the trader's own ship
+    jobs::parallel_for(0, n_traders, TRADERS_GRAIN_SIZE, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            Trader &trader = traders[i];
+            if (trader.state != State::SAILING) continue;
+
+            entt::entity entity = entities[i];
+            auto &ship = registry::registry.get<ship::Ship>(entity);
+            auto &transform = registry::registry.get<components::Transform>(entity);
+            auto &body = registry::registry.get<dynamic_body::DynamicBody>(entity);
+            sail(trader, ship, transform, body);
+        }
+    });
+
+    // posting orders changes the books, so it goes one by one
+    auto ports = registry::get_ports_group().storage<components::Port>()->rbegin();
+    int n_plans = 0;
+    int n_trades = 0;
+    int cursor = PLAN_CURSOR % n_traders;
+    for (int k = 0; k < n_traders; ++k) {
+        int i = (cursor + k) % n_traders;
+        Trader &trader = traders[i];
+        if (trader.state != State::TRADING && trader.state != State::PLANNING) continue;
+        if (trader.state == State::PLANNING && trader.n_wait_ticks > 0) {
+            trader.n_wait_ticks -= 1;
+            continue;
+        }
+        if (trader.state == State::PLANNING && n_plans == MAX_N_PLANS_PER_TICK) continue;
+
+        entt::entity entity = entities[i];
+        auto &ship = registry::registry.get<ship::Ship>(entity);
+
+        if (trader.state == State::TRADING) {
+            entt::entity port_entity = registry::get_port_entity(trader.port_idx);
+            int n_orders = post_cargo(entity, ship, port_entity);
+            trader.state = n_orders > 0 ? State::SELLING : State::PLANNING;
+            trader.n_wait_ticks = 0;
+            n_trades += 1;
+        } else {
+            auto &money = registry::registry.get<components::Money>(entity);
+            plan(trader, entity, ship, money, ports[trader.port_idx]);
+            n_plans += 1;
+            PLAN_CURSOR = i + 1;
+        }
+    }
+
+    profiler::add_counter("traders.n_trades", n_trades);
+    profiler::add_counter("traders.n_plans", n_plans);
+}
+
+void on_match() {
+    auto &storage = registry::registry.storage<Trader>();
+    for (Trader &trader : storage) {
+        // unfilled units stay in the cargo (or the money) for the next port
+        if (trader.state == State::SELLING) trader.state = State::PLANNING;
+        else if (trader.state == State::BUYING) trader.state = State::SAILING;
+    }
+}
+
+}  // namespace trader
+}  // namespace st
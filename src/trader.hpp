@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+
+namespace st {
+namespace trader {
+
+// Trades go through the port's order books: a trader posts NEXT_MATCH
+// orders and waits for the economy tick's match to fill them.
+enum class State : uint8_t {
+    // just arrived: posts the cargo for sale
+    TRADING,
+    // waits for the match of the sell orders
+    SELLING,
+    // waits for its planning slot, then picks a route and posts the orders
+    // for its cargo
+    PLANNING,
+    // waits for the match of the buy orders
+    BUYING,
+    // follows the route's path to the destination dock
+    SAILING,
+};
+
+// Per-ship AI state of an NPC trader (ship::ControllerType::TRADER). It's
+// kept compact: the path is shared by all ships sailing between the same
+// ports (routes::get_path), a trader only keeps its position on it.
+class Trader {
+public:
+    State state = State::TRADING;
+    // SAILING: ticks without moving, PLANNING: ticks left until the next
+    // attempt after a failed one
+    uint8_t n_wait_ticks = 0;
+    uint16_t port_idx;
+    uint16_t dest_port_idx;
+    uint16_t waypoint_idx = 0;
+
+    Trader(int port_idx);
+};
+
+// Subscribes to the port zone events: a sailing trader has arrived as soon
+// as it enters the destination port's zone. Call it after port_zones::load.
+void load();
+
+// Moves traders along their paths (in parallel), then lets the ones which
+// arrived trade and plan. Planning is the expensive part, so only a few
+// traders plan per tick, in round-robin order.
+void update();
+
+// Moves the traders whose orders took part in the match on: sellers to
+// planning, buyers to sailing. Call it right after order_book::match.
+void on_match();
+
+}  // namespace trader
+}  // namespace st
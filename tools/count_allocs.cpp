@@ -0,0 +1,98 @@
+// Counts the heap allocations of redrawing an opened shop whose contents
+// don't change. Every one of them is a regression: the shop caches its text.
+// usage: count_allocs [N_FRAMES]
+
+#include "../src/cargo.hpp"
+#include "../src/components.hpp"
+#include "../src/registry.hpp"
+#include "../src/shop.hpp"
+#include "../src/spawn.hpp"
+#include "../src/ui.hpp"
+#include "raylib/raylib.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<long> N_ALLOCS = 0;
+static std::atomic<bool> IS_COUNTING = false;
+
+void *operator new(std::size_t size) {
+    if (IS_COUNTING) N_ALLOCS += 1;
+    if (void *ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void draw_frame() {
+    BeginDrawing();
+    ClearBackground(BLACK);
+    st::ui::begin();
+    IS_COUNTING = true;
+    st::shop::update_and_draw();
+    IS_COUNTING = false;
+    EndDrawing();
+}
+
+int main(int argc, char **argv) {
+    int n_frames = argc > 1 ? std::atoi(argv[1]) : 60;
+
+    // spawn::create_port needs the terrain, the shop only needs the components
+    auto &registry = st::registry::registry;
+    st::registry::load();
+    st::spawn::create_player({0.0, 0.0});
+    auto port_entity = registry.create();
+    st::cargo::Cargo port_cargo(1000000);
+    port_cargo.add_units(st::cargo::ProductID::RUM_ID, 1000);
+    registry.emplace<st::components::Transform>(port_entity, Vector2{0.0, 0.0}, 0.0);
+    registry.emplace<st::components::Money>(port_entity, 500000);
+    registry.emplace<st::components::Port>(
+        port_entity, 3.0, Vector2{0.0, 0.0}, port_cargo
+    );
+    st::shop::open(port_entity);
+
+    // raylib can't draw without a display and InitWindow crashes without one
+    if (!std::getenv("DISPLAY") && !std::getenv("WAYLAND_DISPLAY")) {
+        std::printf("count_allocs: no display, skipped\n");
+        return 0;
+    }
+
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(1280, 720, "count_allocs");
+    st::ui::load();
+
+    // the first frame lays the shop out and builds the cached text
+    draw_frame();
+    N_ALLOCS = 0;
+    for (int i = 0; i < n_frames; ++i) {
+        draw_frame();
+    }
+
+    st::ui::unload();
+    CloseWindow();
+
+    long n_allocs = N_ALLOCS;
+    std::printf(
+        "count_allocs: %ld allocations in %d shop frames\n", n_allocs, n_frames
+    );
+    return n_allocs == 0 ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+// Hammers the job system from workers and outside threads at once and checks
+// that every job ran exactly once.
+// usage: stress_jobs [N_ROUNDS] [N_WORKERS]
+
+#include "../src/jobs.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+static const int N_SUBMITTERS = 3;
+static const int N_JOBS_PER_SUBMITTER = 2000;
+static const int N_NESTED_JOBS = 4;
+static const int N_FOR_ITEMS = 10000;
+
+// Every job bumps its own slot, a slot other than 1 means a lost or doubled job.
+class Counters {
+public:
+    std::unique_ptr<std::atomic<int>[]> counts;
+    int n_counts;
+
+    explicit Counters(int n_counts)
+        : counts(std::make_unique<std::atomic<int>[]>(n_counts))
+        , n_counts(n_counts) {
+        for (int i = 0; i < n_counts; ++i) counts[i] = 0;
+    }
+
+    int get_n_bad() const {
+        int n_bad = 0;
+        for (int i = 0; i < this->n_counts; ++i) n_bad += this->counts[i] != 1;
+        return n_bad;
+    }
+};
+
+// Jobs that submit and wait for their own nested jobs, so workers push to and
+// pop from their own deques while the others steal from them.
+void submit_jobs(Counters &counters, int first_idx) {
+    st::jobs::Handle handle;
+    for (int i = 0; i < N_JOBS_PER_SUBMITTER; ++i) {
+        int idx = first_idx + i * (N_NESTED_JOBS + 1);
+        st::jobs::submit(
+            [&counters, idx] {
+                counters.counts[idx] += 1;
+
+                st::jobs::Handle nested;
+                for (int j = 1; j <= N_NESTED_JOBS; ++j) {
+                    st::jobs::submit(
+                        [&counters, idx, j] { counters.counts[idx + j] += 1; }, nested
+                    );
+                }
+                st::jobs::wait(nested);
+            },
+            handle
+        );
+    }
+    st::jobs::wait(handle);
+}
+
+int run_round() {
+    int n_submitted = N_JOBS_PER_SUBMITTER * (N_NESTED_JOBS + 1);
+    Counters counters(N_SUBMITTERS * n_submitted + N_FOR_ITEMS);
+
+    // outside threads share one queue and wait without owning a deque
+    std::vector<std::thread> submitters;
+    for (int i = 1; i < N_SUBMITTERS; ++i) {
+        submitters.emplace_back(submit_jobs, std::ref(counters), i * n_submitted);
+    }
+    submit_jobs(counters, 0);
+
+    int for_begin = N_SUBMITTERS * n_submitted;
+    st::jobs::parallel_for(
+        for_begin, for_begin + N_FOR_ITEMS, 64, [&counters](int begin, int end) {
+            for (int i = begin; i < end; ++i) counters.counts[i] += 1;
+        }
+    );
+
+    for (auto &submitter : submitters) submitter.join();
+    return counters.get_n_bad();
+}
+
+int main(int argc, char **argv) {
+    int n_rounds = argc > 1 ? std::atoi(argv[1]) : 100;
+    int n_workers = argc > 2 ? std::atoi(argv[2]) : 4;
+
+    st::jobs::load(n_workers);
+    int n_bad_rounds = 0;
+    for (int round = 0; round < n_rounds; ++round) {
+        int n_bad = run_round();
+        if (n_bad > 0) {
+            std::printf("round %d: %d jobs didn't run exactly once\n", round, n_bad);
+            n_bad_rounds += 1;
+        }
+    }
+    st::jobs::unload();
+
+    std::printf(
+        "stress_jobs: %d rounds on %d workers, %d failed\n",
+        n_rounds,
+        n_workers,
+        n_bad_rounds
+    );
+    return n_bad_rounds == 0 ? 0 : 1;
+}